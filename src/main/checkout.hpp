@@ -1,6 +1,7 @@
 #pragma once
 
 #include "routine.hpp"
+#include "io/reader/estimate_reader.hpp"
 #include "io/reader/header_reader.hpp"
 #include "model/header.hpp"
 
@@ -22,6 +23,35 @@ class Checkout : public Routine
      */
     fs::path m_input;
 
+    /**
+     * The fast mode flag. If set to true, only the relations of the input
+     * file are decoded and the bounds are taken from the file header.
+     */
+    bool m_fast;
+
+    /**
+     * The count flag. If set to true, the nodes and ways are counted in
+     * the fast mode as well.
+     */
+    bool m_count;
+
+    /**
+     * The estimate flag. If set to true, the header is extrapolated from a
+     * sample of the data blocks of the input file.
+     */
+    bool m_estimate;
+
+    /**
+     * The number of sampled node and way blocks in the estimate mode.
+     */
+    int m_samples;
+
+    /**
+     * The number of worker threads. If set to 0, the number of threads is
+     * determined automatically.
+     */
+    int m_threads;
+
     /**
     * The logger.
     */
@@ -35,6 +65,11 @@ public:
     {
         m_options.add_options()
             ("input", po::value<fs::path>()->required(), "Sets the input file path.\nAllowed file formats: .osm, .pbf")
+            ("fast", po::bool_switch()->default_value(false), "Only decodes the relations of the input file.\nThe bounds are taken from the file header if present and the nodes and ways are not counted.")
+            ("count", po::bool_switch()->default_value(false), "Counts the nodes and ways in the fast mode.")
+            ("estimate", po::bool_switch()->default_value(false), "Estimates the node and way counts from a stratified sample of the data blocks.\nThe relation blocks are decoded in full.\nOnly available for .pbf files that are sorted by object type.")
+            ("samples", po::value<int>()->default_value(64), "Sets the number of sampled node and way blocks in the estimate mode.")
+            ("threads,j", po::value<int>()->default_value(0), "Sets the number of worker threads.\nIf set to 0, the number of threads is determined automatically.")
             ("help,h", "Shows this help message");
         m_positional.add("input", 1);
     }
@@ -50,6 +85,11 @@ public:
     {
         Routine::setup();
         this->set<fs::path>(&m_input, "input", util::validate_file);
+        this->set<bool>(&m_fast, "fast");
+        this->set<bool>(&m_count, "count");
+        this->set<bool>(&m_estimate, "estimate");
+        this->set<int>(&m_samples, "samples", util::validate_samples);
+        this->set<int>(&m_threads, "threads", util::validate_threads);
         m_log.set_steps(1);
     }
 
@@ -57,8 +97,22 @@ public:
     {       
         // Read the file info of the specified input file
         m_log.start() << "Reading headers from file " << m_input << ".\n";
-        io::HeaderReader reader{ m_input.string() };
-        model::Header header = reader.read();
+        model::Header header;
+        if (m_estimate)
+        {
+            io::EstimateReader reader{ m_input.string() };
+            reader.samples(static_cast<std::size_t>(m_samples));
+            reader.threads(m_threads);
+            header = reader.read();
+        }
+        else
+        {
+            io::HeaderReader reader{ m_input.string() };
+            reader.mode(m_fast ? io::header_mode::fast : io::header_mode::full);
+            reader.count(m_count);
+            reader.threads(m_threads);
+            header = reader.read();
+        }
         m_log.finish();
 
         util::print(std::cout, header);
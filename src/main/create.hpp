@@ -4,10 +4,15 @@
 
 #include "model/graph/undirected_graph.hpp"
 #include "model/boundary.hpp"
+#include "model/boundary_registry.hpp"
+#include "model/clip_window.hpp"
 #include "model/types.hpp"
 
+#include "io/reader/cache_reader.hpp"
 #include "io/reader/header_reader.hpp"
 #include "io/reader/osm_reader.hpp"
+#include "io/reader/poly_reader.hpp"
+#include "io/writer/cache_writer.hpp"
 #include "io/writer/map_writer.hpp"
 #include "io/writer/mapdata_writer.hpp"
 
@@ -18,7 +23,9 @@
 #include "mapmaker/converter.hpp"
 #include "mapmaker/counter.hpp"
 #include "mapmaker/filter.hpp"
+#include "mapmaker/indexer.hpp"
 #include "mapmaker/inspector.hpp"
+#include "mapmaker/topology.hpp"
 
 #include "functions/transform.hpp"
 
@@ -47,6 +54,8 @@ class Create : public Routine
 
     using buffer_t = osmium::memory::Buffer;
 
+    using location_index_t = model::location_index_type;
+
     using graph_t = graph::UndirectedGraph;
 
     using component_t = std::vector<std::set<osmium::object_id_type>>;
@@ -55,6 +64,8 @@ class Create : public Routine
 
     using hierarchy_t = std::map<object_id_type, std::set<object_id_type>>;
 
+    using transformation_t = std::shared_ptr<functions::Transformation<T>>;
+
     /* Members */
 
     /**
@@ -88,15 +99,97 @@ class Create : public Routine
     int m_height;
 
     /**
-     * The compression distance tolerance for the Douglas-Peucker algorithm.
+     * The compression distance tolerance for the simplification algorithm.
      */
     double m_compression_tolerance;
 
+    /**
+     * The compression distance tolerance in map pixels. If set, the ways are
+     * compressed in the projected map coordinates instead of degrees.
+     */
+    double m_pixel_tolerance;
+
+    /**
+     * The simplification algorithm of the compression, either dp for
+     * Douglas-Peucker or vw for Visvalingam-Whyatt.
+     */
+    std::string m_simplify;
+
+    /**
+     * The topology preservation flag. If set to true, the compression does
+     * not create crossing borders.
+     */
+    bool m_preserve_topology;
+
+    /**
+     * The maximum number of nodes after the compression. If set to 0, the
+     * number of nodes is not limited.
+     */
+    std::size_t m_max_points;
+
+    /**
+     * The maximum estimated size of the map coordinates in bytes. If set to
+     * 0, the size is not limited.
+     */
+    std::size_t m_max_bytes;
+
     /**
      * The surface area tolerance for the filter algorithm.
      */
     double m_filter_tolerance;
 
+    /**
+     * The single pass flag. If set to true, the input file is decoded only
+     * once while reading the boundaries.
+     */
+    bool m_single_pass;
+
+    /**
+     * The number of worker threads. If set to 0, the number of threads is
+     * determined automatically.
+     */
+    int m_threads;
+
+    /**
+     * The node location index backend, which is shared by the compression
+     * and the assembly stages.
+     */
+    std::string m_index;
+
+    /**
+     * The clip window as bounding box string. If set, only boundaries that
+     * intersect the window are extracted.
+     */
+    std::string m_bbox;
+
+    /**
+     * The clip window as polygon file. If set, only boundaries that
+     * intersect the window are extracted.
+     */
+    fs::path m_poly;
+
+    /**
+     * The clip window created from the bounding box or the polygon file.
+     */
+    std::optional<model::ClipWindow> m_clip;
+
+    /**
+     * The directory for the boundary extract cache.
+     */
+    fs::path m_cache_dir;
+
+    /**
+     * The cache flag. If set to false, the boundaries are always read from
+     * the input file and no cache file is written.
+     */
+    bool m_cache;
+
+    /**
+     * The maximum total size of the boundary extract cache in megabytes.
+     * The least recently used cache files are removed beyond this size.
+     */
+    std::size_t m_cache_size;
+
    /**
     * The verbose logging flag.
     */
@@ -121,7 +214,20 @@ public:
             ("width", po::value<int>()->default_value(1000), "Sets the generated map width in pixels.\nIf set to 0, the width will be determined automatically with the height.")
             ("height", po::value<int>()->default_value(0), "Sets the generated map height in pixels.\nIf set to 0, the height will be determined automatically with the width.")
             ("compression-tolerance,c", po::value<double>()->default_value(0.0), "Sets the minimum distance tolerance for the compression algorithm.\nIf set to 0, no compression will be applied.")
+            ("pixel-tolerance", po::value<double>()->default_value(0.0), "Sets the minimum distance tolerance for the compression algorithm in map pixels.\nThe ways are compressed after the projection to the map. As the compression precedes the assembly, the map is fitted to all extracted boundaries instead of the areas kept by the filter, so the map scale may differ from a run without it. Cannot be combined with the compression tolerance.")
+            ("simplify", po::value<std::string>()->default_value("dp"), "Sets the simplification algorithm for the compression.\nAllowed modes: dp (Douglas-Peucker), vw (Visvalingam-Whyatt)")
+            ("preserve-topology", po::bool_switch()->default_value(false), "Prevents the compression from creating self-intersecting or crossing borders.\nThe restored nodes may exceed the compression budget.")
+            ("max-points", po::value<std::size_t>()->default_value(0), "Sets the maximum number of nodes after the compression.\nThe compression tolerance is raised until the budget is met. If set to 0, the number of nodes is not limited.")
+            ("max-bytes", po::value<std::size_t>()->default_value(0), "Sets the maximum estimated size of the map coordinates in bytes.\nThe compression tolerance is raised until the budget is met. If set to 0, the size is not limited.")
             ("filter-tolerance,f", po::value<double>()->default_value(0.0), "Sets the surface area ratio tolerance for filtering boundaries.\nIf set to 0, no filter will be applied.")
+            ("single-pass", po::bool_switch()->default_value(false), "Reads the input file with a single decoding pass.\nThis is faster for large files, but keeps the locations of all nodes in memory.")
+            ("threads,j", po::value<int>()->default_value(0), "Sets the number of worker threads.\nIf set to 0, the number of threads is determined automatically.")
+            ("index", po::value<std::string>()->default_value("flex"), "Sets the node location index backend.\nAllowed types: flex, sparse_mmap, dense_file")
+            ("bbox", po::value<std::string>()->default_value(""), "Sets the clip window as bounding box with the format min_lon,min_lat,max_lon,max_lat.\nOnly boundaries that intersect the window are extracted.")
+            ("poly", po::value<fs::path>()->default_value(""), "Sets the clip window as polygon file in the Osmosis polygon format.\nOnly boundaries that intersect the window are extracted.")
+            ("cache-dir", po::value<fs::path>()->default_value(""), "Sets the directory for the boundary extract cache. If not set, the cache is stored in the executable directory.")
+            ("no-cache", po::bool_switch()->default_value(false), "Disables the boundary extract cache.")
+            ("cache-size", po::value<std::size_t>()->default_value(4096), "Sets the maximum size of the boundary extract cache in megabytes.\nThe least recently used cache files are removed beyond this size.")
             ("verbose", po::bool_switch()->default_value(false), "Enables verbose logging.")
             ("help,h", "Shows this help message.");
         m_positional.add("input", 1);
@@ -147,13 +253,47 @@ public:
         this->set<int>(&m_height, "height");
         util::validate_dimensions(m_width, m_height);
         this->set<double>(&m_compression_tolerance, "compression-tolerance", util::validate_epsilon);
+        this->set<double>(&m_pixel_tolerance, "pixel-tolerance", util::validate_epsilon);
+        util::validate_tolerances(m_compression_tolerance, m_pixel_tolerance);
+        this->set<std::string>(&m_simplify, "simplify", util::validate_simplify);
+        this->set<bool>(&m_preserve_topology, "preserve-topology");
+        this->set<std::size_t>(&m_max_points, "max-points");
+        this->set<std::size_t>(&m_max_bytes, "max-bytes");
         this->set<double>(&m_filter_tolerance, "filter-tolerance", util::validate_epsilon);
+        this->set<bool>(&m_single_pass, "single-pass");
+        this->set<int>(&m_threads, "threads", util::validate_threads);
+        this->set<std::string>(&m_index, "index", util::validate_index);
+        this->set<std::string>(&m_bbox, "bbox", util::validate_bbox);
+        this->set<fs::path>(&m_poly, "poly");
+        util::validate_clip(m_bbox, m_poly);
+        if (!m_bbox.empty())
+        {
+            m_clip = model::ClipWindow{ util::parse_bbox(m_bbox) };
+        }
+        else if (!m_poly.empty())
+        {
+            io::PolyReader poly_reader{ m_poly };
+            m_clip = model::ClipWindow{ poly_reader.read() };
+        }
+        this->set<bool>(&m_cache, "no-cache");
+        m_cache = !m_cache;
+        this->set<fs::path>(&m_cache_dir, "cache-dir", m_dir / "cache");
+        this->set<std::size_t>(&m_cache_size, "cache-size");
+        if (m_cache)
+        {
+            fs::create_directories(m_cache_dir);
+            util::validate_dir(m_cache_dir, "cache-dir");
+        }
         this->set<bool>(&m_verbose, "verbose");
         // fs::create_directory(m_dir / "out");#
-        // Calculate the total number of steps for the routine
-        std::size_t steps = 10 + (m_compression_tolerance > 0.0)
+        // Calculate the total number of steps for the routine from the same
+        // conditions that start the optional steps in run(). The header,
+        // reading, indexing, assembly, neighbor, island, geometry, center,
+        // map building and export steps are always run.
+        std::size_t steps = 10 + compression_enabled()
                     + (m_filter_tolerance > 0.0)
-                    + (!m_bonus_levels.empty());
+                    + (!m_bonus_levels.empty() && !single_assembly())
+                    + !m_bonus_levels.empty();
         m_log.set_steps(steps);
     }
 
@@ -161,48 +301,153 @@ private:
 
     /* Helper methods */
 
+    bool single_assembly() const
+    {
+        // The bonuses must not contain the territories that are removed by
+        // the filter, so they can only be assembled with the territories if
+        // no filter is applied
+        return !m_bonus_levels.empty() && m_filter_tolerance <= 0.0;
+    }
+
+    bool compression_enabled() const
+    {
+        return m_compression_tolerance > 0.0 || m_pixel_tolerance > 0.0 || m_max_points > 0 || m_max_bytes > 0;
+    }
+
     Header read_header(const fs::path& file_path)
     {
-        // Prepare the header reader for the input file and retrieve the header
+        // Prepare the header reader for the input file and retrieve the header.
+        // Only the level distribution is needed, so the nodes and ways are
+        // neither counted nor used for the bounds.
         io::HeaderReader reader{ file_path.string() };
+        reader.mode(io::header_mode::fast);
+        reader.bounds(false);
+        reader.threads(m_threads);
         return reader.read();
     }
 
     osmium::memory::Buffer read_data(const fs::path& file_path, std::set<level_type> levels)
     {
+        // Load the boundaries from the extract cache if the input file, the
+        // read mode and the levels did not change since the cache was
+        // written. Invalid cache files are ignored and overwritten.
+        const io::read_mode mode = m_single_pass ? io::read_mode::single_pass : io::read_mode::multi_pass;
+        fs::path cache_path;
+        if (m_cache)
+        {
+            cache_path = io::cache_path(m_cache_dir, file_path, mode, levels, m_clip);
+            if (fs::exists(cache_path))
+            {
+                try
+                {
+                    io::CacheReader cache_reader{ cache_path };
+                    osmium::memory::Buffer buffer = cache_reader.read();
+                    // Mark the cache file as recently used for the pruning
+                    fs::last_write_time(cache_path, std::time(nullptr));
+                    m_log.step() << "Loaded boundaries from cache " << cache_path << ".\n";
+                    return buffer;
+                }
+                catch (const std::runtime_error& e)
+                {
+                    m_log.warn() << e.what() << ", reading the input file instead.\n";
+                }
+            }
+        }
+
         // Retrieve the administrative boundaries with and admin_level that
         // matches the prepared level filter from the input file
-        io::BoundaryReader reader{ m_input, levels };
-        return reader.read();
+        io::BoundaryReader reader{ file_path, levels };
+        reader.mode(mode);
+        reader.threads(m_threads);
+        if (m_clip.has_value())
+        {
+            reader.clip(m_clip.value());
+        }
+        osmium::memory::Buffer buffer = reader.read();
+
+        // Store the boundaries in the extract cache for the next runs
+        if (m_cache)
+        {
+            try
+            {
+                io::CacheWriter cache_writer{ cache_path };
+                cache_writer.write(buffer);
+                m_log.step() << "Stored boundaries in cache " << cache_path << ".\n";
+                io::prune_cache(m_cache_dir, static_cast<std::uintmax_t>(m_cache_size) * 1024 * 1024);
+            }
+            catch (const std::exception& e)
+            {
+                m_log.warn() << "Boundaries could not be cached: " << e.what() << ".\n";
+            }
+        }
+        return buffer;
+    }
+
+    std::unique_ptr<location_index_t> build_index(mapmaker::Indexer& indexer, const buffer_t& buffer)
+    {
+        // Build the node location index once, such that it can be shared
+        // by the compressor and the assemblers
+        return indexer.run(buffer);
     }
 
-    void compress(buffer_t& buffer)
+    void compress(buffer_t& buffer, const location_index_t& index, const std::vector<transformation_t>& transformations)
     {
         // Count the nodes before the compression
         mapmaker::NodeCounter counter;
         std::size_t before = counter.run(buffer);
 
-        // Compress the extracted ways using the specified compression
-        // tolerance
-        mapmaker::Compressor compressor{ m_compression_tolerance };
+        // Split the ways into shared arcs, such that each border between
+        // boundaries is compressed exactly once
+        mapmaker::TopologyBuilder topology_builder{ index };
+        model::Topology topology = topology_builder.run(buffer);
+
+        // Compress the arcs of the extracted ways using the specified
+        // compression tolerance. If the tolerance is specified in pixels,
+        // the arcs are projected to the map before the compression.
+        const double tolerance = m_pixel_tolerance > 0.0 ? m_pixel_tolerance : m_compression_tolerance;
+        mapmaker::Compressor compressor{ tolerance, topology, m_threads };
+        compressor.projection(transformations);
+        compressor.mode(m_simplify == "vw" ? mapmaker::simplify_mode::vw : mapmaker::simplify_mode::dp);
+        compressor.preserve_topology(m_preserve_topology);
+        compressor.max_points(m_max_points);
+        compressor.max_bytes(m_max_bytes);
         compressor.run(buffer);
 
         // Count the nodes after the compression
         std::size_t after = counter.run(buffer);
 
-        m_log.step() << "Compressed " << before << " nodes to " << after << " nodes.\n";
+        m_log.step() << "Compressed " << before << " nodes to " << after << " nodes with tolerance " << compressor.tolerance() << ".\n";
     }
 
-    void assemble(buffer_t& buffer, std::set<level_type> levels, bool split)
+    buffer_t assemble(buffer_t& buffer, std::set<level_type> levels, bool split, const location_index_t& index, BoundaryRegistry& registry)
     {
         // Create the assembler depending on the split strategy.
-        mapmaker::Assembler assembler{ levels, split };
-        assembler.run(buffer);
+        mapmaker::Assembler assembler{ levels, index, split };
+        assembler.threads(m_threads);
+        return assembler.run(buffer, registry);
+    }
+
+    buffer_t assemble_levels(buffer_t& buffer, std::set<level_type> levels, std::set<level_type> split_levels, const location_index_t& index, BoundaryRegistry& registry)
+    {
+        // Create the assembler that assembles all levels at once and splits
+        // the areas of the split levels.
+        mapmaker::Assembler assembler{ levels, split_levels, index };
+        assembler.threads(m_threads);
+        return assembler.run(buffer, registry);
+    }
+
+    void release(buffer_t& buffer, std::unique_ptr<location_index_t>& index)
+    {
+        // Free the raw objects and the node locations, which are not used
+        // after the last assembly step.
+        buffer = buffer_t{};
+        index.reset();
     }
 
     graph_t get_neighbors(const buffer_t& buffer, level_type level)
     {
         mapmaker::NeighborInspector inspector{ level };
+        inspector.threads(m_threads);
         return inspector.run(buffer);
     }
 
@@ -212,17 +457,17 @@ private:
         return inspector.run(neighbors);
     }
     
-    void filter(buffer_t& buffer, graph_t& neighbors, component_t& components){
+    void filter(buffer_t& buffer, buffer_t& areas, const BoundaryRegistry& registry, graph_t& neighbors, component_t& components){
         // Count the areas before the filter process
         mapmaker::AreaCounter counter;
-        std::size_t before = counter.run(buffer);
+        std::size_t before = counter.run(areas);
 
         // Apply the area filter on the area buffer using the specified tolerance
         mapmaker::AreaFilter filter{ m_filter_tolerance };
-        filter.run(buffer, neighbors, components);
+        filter.run(buffer, areas, registry, neighbors, components);
 
         // Count the nodes after the filter process
-        std::size_t after = counter.run(buffer);
+        std::size_t after = counter.run(areas);
 
         m_log.step() << "Compressed " << before << " nodes to " << after << " nodes.\n";
     }
@@ -234,11 +479,11 @@ private:
         transformation.transform(bounds.max().x(), bounds.max().y());
     }
 
-    container_t convert(buffer_t& buffer)
-    {     
-        // Prepare the transformations that will be applied on the buffer before
-        // the geometry conversion. At first, calculate the bounding box of the
-        // nodes in the buffer.
+    std::vector<transformation_t> projection(const buffer_t& buffer)
+    {
+        // Prepare the transformations that map the node locations to the
+        // map pixels. At first, calculate the bounding box of the nodes or
+        // the area rings in the buffer.
         mapmaker::BoundsCalculator<T> bounds_calculator{};
         geometry::Rectangle<T> bounds = bounds_calculator.run(buffer);
 
@@ -281,15 +526,20 @@ private:
         // The scaling transformation maps the normalized 
         functions::ScaleTransformation<T> scale_transformation{ (double) m_width, (double) m_height };
 
-        // Create the converter, which will apply the specified transformations
-        // and convert the areas to multipolygon geometries afterwards.
-        mapmaker::BoundaryConverter<T> converter{
+        return {
             std::make_shared<functions::RadianTransformation<T>>(radian_transformation),
             std::make_shared<functions::MercatorProjection<T>>(mercator_transformation),
             std::make_shared<functions::UnitTransformation<T>>(normalize_transformation),
             // std::make_shared<functions::MirrorTransformation<T>>(mirror_transformation),
             std::make_shared<functions::ScaleTransformation<T>>(scale_transformation)
         };
+    }
+
+    container_t convert(buffer_t& buffer, const std::vector<transformation_t>& transformations)
+    {
+        // Create the converter, which will apply the specified transformations
+        // and convert the areas to multipolygon geometries afterwards.
+        mapmaker::BoundaryConverter<T> converter{ transformations };
         return converter.run(buffer);
     }
 
@@ -376,63 +626,116 @@ public:
         buffer_t buffer = read_data(m_input, levels);
         m_log.finish();
 
-        // Step 3: Compress the extracted ways using the Douglas-Peucker
-        // algorithm if a compression threshold was specified.
-        if (m_compression_tolerance > 0)
+        // Step 3: Build the node location index with the selected backend.
+        // The index is shared by the compression and the assembly steps.
+        m_log.start() << "Indexing node locations with index type " << m_index << ".\n";
+        mapmaker::Indexer indexer{ m_index };
+        std::unique_ptr<location_index_t> index = build_index(indexer, buffer);
+        m_log.finish();
+
+        // Step 4: Compress the extracted ways using the selected simplification
+        // algorithm if a compression threshold or budget was specified.
+        std::vector<transformation_t> transformations;
+        if (compression_enabled())
+        {
+            // The pixel tolerance needs the projection before the assembly,
+            // so the map is fitted to all extracted boundaries instead of
+            // the kept areas. The projection is reused by the conversion,
+            // such that the tolerance is measured in the pixels of the
+            // final map.
+            if (m_pixel_tolerance > 0.0)
+            {
+                transformations = projection(buffer);
+            }
+            m_log.start() << "Compressing ways with tolerance "
+                << (m_pixel_tolerance > 0.0 ? m_pixel_tolerance : m_compression_tolerance)
+                << (m_pixel_tolerance > 0.0 ? " pixels" : "")
+                << " and mode " << m_simplify << ".\n";
+            compress(buffer, *index, transformations);
+            m_log.finish();
+        }
+
+        // Step 5: Assemble the territory boundaries using the built-in
+        // multipolygon assembler. The bonus boundaries are assembled in the
+        // same pass, unless the filter removes territories first. The areas
+        // are kept in a separate buffer from the raw objects and are identified
+        // by dense boundary ids from the registry.
+        BoundaryRegistry registry;
+        buffer_t areas;
+        if (single_assembly())
+        {
+            std::set<level_type> levels{ m_bonus_levels.begin(), m_bonus_levels.end() };
+            levels.insert(m_territory_level);
+            m_log.start() << "Assembling territories with level " << m_territory_level
+                << " and bonuses with the levels " << util::join(m_bonus_levels) << ".\n";
+            areas = assemble_levels(buffer, levels, { m_territory_level }, *index, registry);
+            m_log.finish();
+        }
+        else
         {
-            m_log.start() << "Compressing ways with tolerance " << m_compression_tolerance << ".\n";
-            compress(buffer);
+            m_log.start() << "Assembling territories with level " << m_territory_level << ".\n";
+            areas = assemble(buffer, { m_territory_level }, true, *index, registry);
             m_log.finish();
         }
 
-        // Step 4: Assemble the territory boundaries using the built-in
-        // multipolygon assembler.
-        m_log.start() << "Assembling territories with level " << m_territory_level << ".\n";
-        assemble(buffer, { m_territory_level }, true);
-        m_log.finish();
+        // Release the raw data if no bonus assembly follows.
+        if (single_assembly() || m_bonus_levels.empty())
+        {
+            release(buffer, index);
+        }
         
-        // Step 5: Create the neighbor graph for the assembled territories.
+        // Step 6: Create the neighbor graph for the assembled territories.
         m_log.start() << "Calculating neighborships for territories.\n";
-        graph::UndirectedGraph neighbors = get_neighbors(buffer, m_territory_level);
+        graph::UndirectedGraph neighbors = get_neighbors(areas, m_territory_level);
         m_log.finish();
 
-        // Step 6: Calculate the connected components for the neighbor graph.
+        // Step 7: Calculate the connected components for the neighbor graph.
         // This yields the islands of the map.
         m_log.start() << "Finding territory islands.\n";
         component_t components = get_components(neighbors);
         m_log.finish();
 
-        // Step 7: Filter connected components by their surface area if a filter
+        // Step 8: Filter connected components by their surface area if a filter
         // threshold was specified.
         if (m_filter_tolerance > 0)
         {
             m_log.start() << "Compressing ways with tolerance " << m_filter_tolerance << ".\n";
-            filter(buffer, neighbors, components);
+            filter(buffer, areas, registry, neighbors, components);
             m_log.finish();
         }
 
-        // Step 8: Assemble the bonus boundarties using the built-in multipolygon
-        // assembler if any bonus levels were specified.
-        if (!m_bonus_levels.empty())
+        // Step 9: Assemble the bonus boundarties using the built-in multipolygon
+        // assembler if any bonus levels were specified and they were not
+        // assembled with the territories.
+        if (!m_bonus_levels.empty() && !single_assembly())
         {
             m_log.start() << "Assembling bonuses with the levels " << util::join(m_bonus_levels) << ".\n";
-            assemble(buffer, std::set<level_type>(m_bonus_levels.begin(), m_bonus_levels.end()), false);
+            buffer_t bonuses = assemble(buffer, std::set<level_type>(m_bonus_levels.begin(), m_bonus_levels.end()), false, *index, registry);
+            areas.add_buffer(bonuses);
+            areas.commit();
             m_log.finish();
+
+            release(buffer, index);
         }
         
-        // Step 9: Create the boundary geometries from the assembled boundaries by
+        // Step 10: Create the boundary geometries from the assembled boundaries by
         // applying the map projections and transformations first and converting
         // the osmium objects to geometry objects afterwards.
         m_log.start() << "Building the boundary geometries from the OpenStreetMap objects.\n";
-        std::map<object_id_type, Boundary<T>> boundaries = convert(buffer);
+        if (transformations.empty())
+        {
+            // The projection fits the map to the rings of the kept areas
+            transformations = projection(areas);
+        }
+        std::map<object_id_type, Boundary<T>> boundaries = convert(areas, transformations);
         m_log.finish();
         
-        // Step 10: Calculate the center points for each boundary
+        // Step 11: Calculate the center points for each boundary
         m_log.start() << "Calculating the center points for " << boundaries.size() << " boundaries.\n";
         calculate_centers(boundaries);
         m_log.finish();
 
-        // Step 11: Calculate the hirarchy of territories, bonuses and super bonuses
+        // Step 12: Calculate the hirarchy of territories, bonuses and super bonuses
         // if any bonus levels were specified
         hierarchy_t hierarchy = {};
         if (!m_bonus_levels.empty())
@@ -442,7 +745,7 @@ public:
             m_log.finish();
         }
 
-        // Step 12: Build the map with the generated data
+        // Step 13: Build the map with the generated data
         m_log.start() << "Building the Warzone map.\n";
         // Create the map name from the input file name
         std::string name = std::regex_replace(
@@ -454,7 +757,7 @@ public:
         warzone::Map map = build_map(name, boundaries, neighbors, hierarchy);
         m_log.finish();
 
-        // Step 13: Export the generated Warzone map and the calculated mapdata
+        // Step 14: Export the generated Warzone map and the calculated mapdata
         // to the specified output directory
         m_log.start() << "Exporting the generated map files.\n";
         export_map(std::move(map));
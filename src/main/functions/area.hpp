@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "model/geometry/point.hpp"
 #include "model/geometry/rectangle.hpp"
 #include "model/geometry/ring.hpp"
@@ -11,6 +13,22 @@ using namespace model::geometry;
 namespace functions
 {
 
+    /**
+     * Calculate the surface area of the triangle spanned by three points.
+     * 
+     * @param a The first point
+     * @param b The second point
+     * @param c The third point
+     * @returns The area of the triangle
+     * 
+     * Time complexity: Constant
+     */
+    template <typename T>
+    inline double area(const Point<T>& a, const Point<T>& b, const Point<T>& c)
+    {
+        return std::abs((b.x() - a.x()) * (c.y() - a.y()) - (c.x() - a.x()) * (b.y() - a.y())) / 2.0;
+    }
+
     /**
      * Calculate the surface area of a rectangle.
      * 
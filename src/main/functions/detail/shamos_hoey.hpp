@@ -1,5 +1,7 @@
 #pragma once
 
+#include <map>
+#include <queue>
 #include <set>
 #include <vector>
 
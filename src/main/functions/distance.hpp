@@ -1,6 +1,12 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include "model/geometry/point.hpp"
 #include "model/geometry/rectangle.hpp"
@@ -68,6 +74,113 @@ namespace functions
         return distance(ps, line_plumb);
     }
 
+    /**
+     * Find the point with the greatest perpendicular distance to the line
+     * through two points in a run of coordinates, which are stored as
+     * structure of arrays.
+     *
+     * The distances are compared by the absolute cross product, so the
+     * division by the line length is only applied to the maximum. If the
+     * program is compiled with AVX2 support, four points are processed per
+     * instruction. Otherwise, the scalar loop is used. Both find the first
+     * point with the greatest distance.
+     *
+     * @param xs    The x coordinates
+     * @param ys    The y coordinates
+     * @param first The index of the first point of the run
+     * @param last  The past-the-end index of the run
+     * @param a     The first point of the line
+     * @param b     The second point of the line
+     * @returns     The index of the farthest point and its distance, or
+     *              first and -1 if the run is empty
+     *
+     * Time complexity: Linear
+     */
+    inline std::pair<std::size_t, double> max_perpendicular_distance(
+        const double* xs,
+        const double* ys,
+        std::size_t first,
+        std::size_t last,
+        const Point<double>& a,
+        const Point<double>& b
+    ) {
+        const double dx = b.x() - a.x();
+        const double dy = b.y() - a.y();
+        const double length = std::hypot(dx, dy);
+        std::size_t index = first;
+        double c_max = -1.0;
+
+        // If the line points are the same, the distance is the distance to
+        // the line point
+        if (length == 0.0)
+        {
+            for (std::size_t i = first; i < last; i++)
+            {
+                double d = std::hypot(xs[i] - a.x(), ys[i] - a.y());
+                if (d > c_max)
+                {
+                    index = i;
+                    c_max = d;
+                }
+            }
+            return { index, c_max };
+        }
+
+        std::size_t i = first;
+#if defined(__AVX2__)
+        if (last - first >= 4)
+        {
+            const __m256d v_dx = _mm256_set1_pd(dx);
+            const __m256d v_dy = _mm256_set1_pd(dy);
+            const __m256d v_ax = _mm256_set1_pd(a.x());
+            const __m256d v_ay = _mm256_set1_pd(a.y());
+            const __m256d v_sign = _mm256_set1_pd(-0.0);
+            const __m256d v_step = _mm256_set1_pd(4.0);
+            __m256d v_max = _mm256_set1_pd(-1.0);
+            __m256d v_index = _mm256_set_pd(double(i + 3), double(i + 2), double(i + 1), double(i));
+            __m256d v_best = v_index;
+            for (; i + 4 <= last; i += 4)
+            {
+                const __m256d px = _mm256_sub_pd(_mm256_loadu_pd(xs + i), v_ax);
+                const __m256d py = _mm256_sub_pd(_mm256_loadu_pd(ys + i), v_ay);
+                const __m256d c = _mm256_andnot_pd(
+                    v_sign,
+                    _mm256_sub_pd(_mm256_mul_pd(v_dx, py), _mm256_mul_pd(v_dy, px))
+                );
+                const __m256d mask = _mm256_cmp_pd(c, v_max, _CMP_GT_OQ);
+                v_max = _mm256_blendv_pd(v_max, c, mask);
+                v_best = _mm256_blendv_pd(v_best, v_index, mask);
+                v_index = _mm256_add_pd(v_index, v_step);
+            }
+
+            // Reduce the lanes to the first point with the greatest distance
+            alignas(32) double lane_max[4];
+            alignas(32) double lane_best[4];
+            _mm256_store_pd(lane_max, v_max);
+            _mm256_store_pd(lane_best, v_best);
+            for (std::size_t lane = 0; lane < 4; lane++)
+            {
+                const std::size_t lane_index = static_cast<std::size_t>(lane_best[lane]);
+                if (lane_max[lane] > c_max || (lane_max[lane] == c_max && lane_index < index))
+                {
+                    index = lane_index;
+                    c_max = lane_max[lane];
+                }
+            }
+        }
+#endif
+        for (; i < last; i++)
+        {
+            double c = std::abs(dx * (ys[i] - a.y()) - dy * (xs[i] - a.x()));
+            if (c > c_max)
+            {
+                index = i;
+                c_max = c;
+            }
+        }
+        return { index, c_max < 0.0 ? c_max : c_max / length };
+    }
+
     /**
      * Calculate the minimal (signed) distance of to a ring.
      * 
@@ -134,6 +134,29 @@ namespace functions
         return (s >= 0 && s <= 1 && t >= 0 && t <= 1);
     }
 
+    /**
+     * Check if two segments cross, i.e. if they intersect in a single point
+     * that is not an endpoint of either segment. Touching and collinear
+     * segments do not cross.
+     *
+     * @param s1 The first segment
+     * @param s2 The second segment
+     * @returns  True if the segments cross
+     *
+     * Time complexity: Constant
+     */
+    template <typename T>
+    inline bool segments_cross(const Segment<T>& s1, const Segment<T>& s2)
+    {
+        // Determine on which side of the line p-q the point r lies
+        auto orientation = [](const Point<T>& p, const Point<T>& q, const Point<T>& r) {
+            double d = (q.x() - p.x()) * (r.y() - p.y()) - (q.y() - p.y()) * (r.x() - p.x());
+            return (d > 0) - (d < 0);
+        };
+        return orientation(s1.first(), s1.last(), s2.first()) * orientation(s1.first(), s1.last(), s2.last()) < 0
+            && orientation(s2.first(), s2.last(), s1.first()) * orientation(s2.first(), s2.last(), s1.last()) < 0;
+    }
+
     /**
      * Check if a point is inside of a ring using
      * the ray-casting algorithm (also knowsn as even-odd
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stack>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "model/geometry/line.hpp"
+
+#include "functions/area.hpp"
+#include "functions/distance.hpp"
+
+using namespace model::geometry;
+
+namespace functions
+{
+
+    /**
+     * Split the points of a line into separate coordinate arrays.
+     *
+     * @param line The line
+     * @param xs   The x coordinates
+     * @param ys   The y coordinates
+     *
+     * Time complexity: Linear
+     */
+    template <typename T>
+    inline void split_coordinates(const Line<T>& line, std::vector<double>& xs, std::vector<double>& ys)
+    {
+        xs.resize(line.size());
+        ys.resize(line.size());
+        for (std::size_t i = 0; i < line.size(); i++)
+        {
+            xs[i] = double(line[i].x());
+            ys[i] = double(line[i].y());
+        }
+    }
+
+    /**
+     * Simplify a line with the Douglas-Peucker-Algorithm.
+     * This method implements the iterative version of the algorithm,
+     * as the recursive method initializes multiple new collections
+     * that will be destroyed afterwards anyway.
+     *
+     * The first and the last point of the line are always kept.
+     *
+     * For more information on the original algorithm, refer to
+     * https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
+     *
+     * @param line      The line
+     * @param tolerance The distance tolerance (epsilon)
+     * @returns         The flags that indicate which points of the line
+     *                  are kept
+     *
+     * Time complexity: Log-Linear (Average-case), Quadratic (Worst-case)
+     */
+    template <typename T>
+    inline std::vector<bool> douglas_peucker(const Line<T>& line, double tolerance)
+    {
+        std::vector<bool> kept(line.size(), true);
+        if (line.size() < 3)
+        {
+            return kept;
+        }
+
+        // Store the coordinates as structure of arrays for the distance
+        // kernel
+        std::vector<double> xs;
+        std::vector<double> ys;
+        split_coordinates(line, xs, ys);
+
+        // Create the index stack for the iterative version
+        // of the algorithm
+        std::stack<std::pair<std::size_t, std::size_t>> stack;
+        stack.push(std::make_pair(0, line.size() - 1));
+
+        while (!stack.empty())
+        {
+            // Get the current start and end index
+            auto [start, end] = stack.top();
+            stack.pop();
+
+            // Find the point with the greatest perpendicular distance to
+            // the line between the current start and end point
+            auto [index, d_max] = max_perpendicular_distance(
+                xs.data(), ys.data(), start + 1, end,
+                Point<double>{ xs[start], ys[start] },
+                Point<double>{ xs[end], ys[end] }
+            );
+
+            // Check if the maximum distance is greater than the upper tolerance
+            if (d_max > tolerance)
+            {
+                // Simplify the left and right part of the line
+                stack.push(std::make_pair(start, index));
+                stack.push(std::make_pair(index, end));
+            }
+            else
+            {
+                // Remove all points between the start and end point
+                for (std::size_t i = start + 1; i < end; i++)
+                {
+                    kept[i] = false;
+                }
+            }
+        }
+        return kept;
+    }
+
+    /**
+     * Calculate the split distances of the points of a line for the
+     * Douglas-Peucker-Algorithm.
+     *
+     * The line is split recursively at the point with the greatest
+     * perpendicular distance until no points are left. The split distance
+     * of a point is its distance at the split, capped by the split distance
+     * of the enclosing split. A point is kept by douglas_peucker() exactly
+     * if its split distance is greater than the tolerance, so the result can
+     * be thresholded for any tolerance without another simplification. The
+     * first and the last point have an infinite split distance.
+     *
+     * @param line The line
+     * @returns    The split distance of each point
+     *
+     * Time complexity: Log-Linear (Average-case), Quadratic (Worst-case)
+     */
+    template <typename T>
+    inline std::vector<double> split_distances(const Line<T>& line)
+    {
+        std::vector<double> distances(line.size(), std::numeric_limits<double>::infinity());
+        if (line.size() < 3)
+        {
+            return distances;
+        }
+
+        // Store the coordinates as structure of arrays for the distance
+        // kernel
+        std::vector<double> xs;
+        std::vector<double> ys;
+        split_coordinates(line, xs, ys);
+
+        // Create the stack of the start index, the end index and the split
+        // distance of the enclosing split
+        std::stack<std::tuple<std::size_t, std::size_t, double>> stack;
+        stack.push(std::make_tuple(0, line.size() - 1, std::numeric_limits<double>::infinity()));
+
+        while (!stack.empty())
+        {
+            auto [start, end, cap] = stack.top();
+            stack.pop();
+            if (end - start < 2)
+            {
+                continue;
+            }
+
+            // Find the point with the greatest perpendicular distance to
+            // the line between the current start and end point
+            auto [index, d_max] = max_perpendicular_distance(
+                xs.data(), ys.data(), start + 1, end,
+                Point<double>{ xs[start], ys[start] },
+                Point<double>{ xs[end], ys[end] }
+            );
+
+            // Split the line at the point in any case
+            distances[index] = std::min(d_max, cap);
+            stack.push(std::make_tuple(start, index, distances[index]));
+            stack.push(std::make_tuple(index, end, distances[index]));
+        }
+        return distances;
+    }
+
+    /**
+     * Calculate the effective areas of the points of a line for the
+     * Visvalingam-Whyatt-Algorithm.
+     *
+     * The points are removed in the order of the area of the triangle they
+     * form with their current neighbors, which is updated for the neighbors
+     * after each removal. The effective area of a point is the area at its
+     * removal, raised to the effective area of the previously removed point,
+     * such that the areas are monotonic in the removal order. The first and
+     * the last point have an infinite effective area.
+     *
+     * For more information on the original algorithm, refer to
+     * https://en.wikipedia.org/wiki/Visvalingam%E2%80%93Whyatt_algorithm
+     *
+     * @param line The line
+     * @returns    The effective area of each point
+     *
+     * Time complexity: Log-Linear
+     */
+    template <typename T>
+    inline std::vector<double> effective_areas(const Line<T>& line)
+    {
+        const std::size_t n = line.size();
+        std::vector<double> areas(n, std::numeric_limits<double>::infinity());
+        if (n < 3)
+        {
+            return areas;
+        }
+
+        // Link the points, such that removed points can be skipped
+        std::vector<std::size_t> prev(n);
+        std::vector<std::size_t> next(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            prev[i] = i - 1;
+            next[i] = i + 1;
+        }
+
+        // Push the initial triangle areas on a min-heap. Entries of updated
+        // areas are not removed from the heap, but skipped when popped.
+        using entry_type = std::pair<double, std::size_t>;
+        std::priority_queue<entry_type, std::vector<entry_type>, std::greater<entry_type>> heap;
+        for (std::size_t i = 1; i < n - 1; i++)
+        {
+            areas[i] = area(line.at(i - 1), line.at(i), line.at(i + 1));
+            heap.push({ areas[i], i });
+        }
+
+        std::vector<bool> removed(n, false);
+        double last = 0.0;
+        while (!heap.empty())
+        {
+            auto [a, i] = heap.top();
+            heap.pop();
+            if (removed[i] || a != areas[i])
+            {
+                continue;
+            }
+
+            // Remove the point and store its effective area
+            last = std::max(a, last);
+            areas[i] = last;
+            removed[i] = true;
+            const std::size_t p = prev[i];
+            const std::size_t q = next[i];
+            next[p] = q;
+            prev[q] = p;
+
+            // Update the triangle areas of the neighbors
+            if (p > 0)
+            {
+                areas[p] = area(line.at(prev[p]), line.at(p), line.at(q));
+                heap.push({ areas[p], p });
+            }
+            if (q < n - 1)
+            {
+                areas[q] = area(line.at(p), line.at(q), line.at(next[q]));
+                heap.push({ areas[q], q });
+            }
+        }
+        return areas;
+    }
+
+    /**
+     * Simplify a line with the Visvalingam-Whyatt-Algorithm.
+     *
+     * The first and the last point of the line are always kept.
+     *
+     * @param line      The line
+     * @param tolerance The effective area tolerance
+     * @returns         The flags that indicate which points of the line
+     *                  are kept
+     *
+     * Time complexity: Log-Linear
+     */
+    template <typename T>
+    inline std::vector<bool> visvalingam_whyatt(const Line<T>& line, double tolerance)
+    {
+        const std::vector<double> areas = effective_areas(line);
+        std::vector<bool> kept(line.size());
+        for (std::size_t i = 0; i < line.size(); i++)
+        {
+            kept[i] = areas[i] > tolerance;
+        }
+        return kept;
+    }
+
+}
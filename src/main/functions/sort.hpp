@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <vector>
+
+#include <osmium/thread/pool.hpp>
+
+namespace functions
+{
+
+    /**
+     * Sort values by an unsigned 64-bit key with a parallel least significant
+     * digit radix sort.
+     *
+     * The values are partitioned into chunks, which are processed on the
+     * worker pool. Each pass counts the digits of every chunk, calculates
+     * the output offsets of each chunk and bucket, and scatters the chunks
+     * in parallel. Passes for digits that are equal for all keys are
+     * skipped, so small keys like node ids only require a few passes. The
+     * sort is stable.
+     *
+     * @param values The values
+     * @param key    The key function, which maps a value to its key
+     * @param pool   The worker pool
+     *
+     * Time complexity: Linear
+     */
+    template <typename T, typename F>
+    inline void radix_sort(std::vector<T>& values, F&& key, osmium::thread::Pool& pool)
+    {
+        constexpr std::size_t CHUNKS_PER_THREAD = 4;
+        constexpr std::size_t DIGIT_BITS = 8;
+        constexpr std::size_t BUCKETS = std::size_t(1) << DIGIT_BITS;
+        constexpr std::size_t DIGITS = 64 / DIGIT_BITS;
+
+        using histogram_type = std::array<std::size_t, BUCKETS>;
+
+        const std::size_t n = values.size();
+        if (n < 2)
+        {
+            return;
+        }
+
+        const std::size_t chunks = std::min<std::size_t>(
+            n,
+            CHUNKS_PER_THREAD * static_cast<std::size_t>(std::max(pool.num_threads(), 1))
+        );
+        auto for_each_chunk = [&](auto&& function) {
+            std::vector<std::future<void>> results;
+            for (std::size_t c = 0; c < chunks; c++)
+            {
+                const std::size_t first = c * n / chunks;
+                const std::size_t last = (c + 1) * n / chunks;
+                results.push_back(pool.submit([&function, c, first, last]() {
+                    function(c, first, last);
+                }));
+            }
+            for (auto& result : results)
+            {
+                result.get();
+            }
+        };
+
+        // Find the digits that differ between the keys. The minimum and
+        // maximum key are not sufficient, as keys may share high digits
+        // while low digits vary.
+        std::vector<std::uint64_t> ors(chunks, 0);
+        std::vector<std::uint64_t> ands(chunks, ~std::uint64_t(0));
+        for_each_chunk([&](std::size_t c, std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; i++)
+            {
+                const std::uint64_t k = key(values[i]);
+                ors[c] |= k;
+                ands[c] &= k;
+            }
+        });
+        std::uint64_t varying = 0;
+        std::uint64_t common = ~std::uint64_t(0);
+        for (std::size_t c = 0; c < chunks; c++)
+        {
+            varying |= ors[c];
+            common &= ands[c];
+        }
+        varying &= ~common;
+
+        std::vector<T> buffer(n);
+        std::vector<histogram_type> histograms(chunks);
+        for (std::size_t d = 0; d < DIGITS; d++)
+        {
+            const std::size_t shift = d * DIGIT_BITS;
+            if (((varying >> shift) & (BUCKETS - 1)) == 0)
+            {
+                continue;
+            }
+
+            // Count the digits of each chunk
+            for_each_chunk([&](std::size_t c, std::size_t first, std::size_t last) {
+                histogram_type& histogram = histograms[c];
+                histogram.fill(0);
+                for (std::size_t i = first; i < last; i++)
+                {
+                    ++histogram[(key(values[i]) >> shift) & (BUCKETS - 1)];
+                }
+            });
+
+            // Turn the counts into output offsets, ordered by bucket first
+            // and chunk second, which keeps the sort stable
+            std::size_t offset = 0;
+            for (std::size_t b = 0; b < BUCKETS; b++)
+            {
+                for (std::size_t c = 0; c < chunks; c++)
+                {
+                    const std::size_t count = histograms[c][b];
+                    histograms[c][b] = offset;
+                    offset += count;
+                }
+            }
+
+            // Scatter the values of each chunk to their offsets
+            for_each_chunk([&](std::size_t c, std::size_t first, std::size_t last) {
+                histogram_type& offsets = histograms[c];
+                for (std::size_t i = first; i < last; i++)
+                {
+                    buffer[offsets[(key(values[i]) >> shift) & (BUCKETS - 1)]++] = values[i];
+                }
+            });
+            values.swap(buffer);
+        }
+    }
+
+}
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <osmium/index/id_set.hpp>
 #include <osmium/index/nwr_array.hpp>
@@ -8,6 +10,7 @@
 #include <osmium/tags/tags_filter.hpp>
 #include <osmium/relations/relations_manager.hpp>
 
+#include "model/clip_window.hpp"
 #include "model/types.hpp"
 
 namespace handler
@@ -25,11 +28,15 @@ namespace handler
      */
     class BoundaryManager : public osmium::relations::RelationsManager<BoundaryManager, false, true, false>
     {
-    protected:
+    public:
 
         /* Types */
 
-        using nwr_array = osmium::nwr_array<osmium::index::IdSetDense<osmium::unsigned_object_id_type>>;
+        using id_set_type = osmium::index::IdSetDense<osmium::unsigned_object_id_type>;
+
+        using nwr_array = osmium::nwr_array<id_set_type>;
+
+    protected:
 
         /* Members */   
 
@@ -43,18 +50,86 @@ namespace handler
         */
         nwr_array m_matching_ids;
 
+        /**
+         * The clip window. If set, only boundaries that intersect the window
+         * or enclose it are marked. The node locations of the ways have to
+         * be set.
+         */
+        const model::ClipWindow* m_window = nullptr;
+
         /* Methods */
 
         /**
-         * 
+         * Check if a segment of a way intersects the clip window. If no clip
+         * window is set, all ways intersect it.
+         *
+         * Time complexity: Linear
+         */
+        bool intersects(const osmium::Way& way) const
+        {
+            if (m_window == nullptr)
+            {
+                return true;
+            }
+            const osmium::WayNodeList& nodes = way.nodes();
+            if (nodes.size() == 1)
+            {
+                return m_window->contains(nodes.front().location());
+            }
+            for (std::size_t i = 1; i < nodes.size(); i++)
+            {
+                if (m_window->intersects(nodes[i - 1].location(), nodes[i].location()))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Count the crossings of the segments of a way with the reference
+         * rays of the clip window, one count per reference point.
+         *
+         * @param way       The way
+         * @param crossings The crossing counts, which are incremented
+         *
+         * Time complexity: Linear in the number of nodes times the number
+         * of reference points
+         */
+        void reference_crossings(const osmium::Way& way, std::vector<std::size_t>& crossings) const
+        {
+            const osmium::WayNodeList& nodes = way.nodes();
+            for (std::size_t r = 0; r < crossings.size(); r++)
+            {
+                for (std::size_t i = 1; i < nodes.size(); i++)
+                {
+                    crossings[r] += m_window->crosses_reference_ray(nodes[i - 1].location(), nodes[i].location(), r);
+                }
+            }
+        }
+
+        /**
+         * Check if closed rings enclose a polygon of the clip window, which
+         * is the case if the crossings with any reference ray are odd.
+         *
+         * @param crossings The crossing counts per reference point
+         * @returns         True if a reference point lies inside
+         */
+        static bool encloses(const std::vector<std::size_t>& crossings)
+        {
+            return std::any_of(crossings.begin(), crossings.end(), [](std::size_t c) { return c % 2 == 1; });
+        }
+
+        /**
+         * Check if a way is closed by its node references. The node
+         * locations are not used, as they are only set when clipping, so
+         * the same ways qualify with and without a clip window.
          */
         bool is_polygon(const osmium::Way& way) const
         {
             return way.nodes().size() > 3
                 && !way.tags().has_tag("area", "no")
-                && way.nodes().front().location()
-                && way.nodes().back().location()
-                && way.ends_have_same_location();
+                && way.is_closed();
         }
 
     public:
@@ -76,6 +151,31 @@ namespace handler
             return m_matching_ids;
         }
 
+        /* Setters */
+
+        /**
+         * Set the clip window. The window has to outlive the manager.
+         */
+        void clip(const model::ClipWindow* window)
+        {
+            m_window = window;
+        }
+
+        /* Methods */
+
+        /**
+         * Check if a way is a closed boundary way, that is a polygon whose
+         * tags match the filter. These ways are marked by after_way
+         * independently of any relation.
+         *
+         * @param way The way
+         * @returns   True if the way is a closed boundary way
+         */
+        bool is_boundary_way(const osmium::Way& way) const
+        {
+            return is_polygon(way) && osmium::tags::match_any_of(way.tags(), m_filter);
+        }
+
         /* Osmium Methods */
 
         /**
@@ -113,9 +213,35 @@ namespace handler
          */
         void complete_relation(const osmium::Relation& relation)
         {
+            // Drop the relation if none of its ways intersects the clip
+            // window and its rings do not enclose a polygon of the window.
+            // The rings are closed, so the parity of the reference ray
+            // crossings over all member ways tells if a polygon lies inside.
+            if (m_window != nullptr)
+            {
+                bool inside = false;
+                std::vector<std::size_t> crossings(m_window->references().size(), 0);
+                for (const osmium::RelationMember& member : relation.members())
+                {
+                    if (member.ref() == 0)
+                    {
+                        continue;
+                    }
+                    const osmium::Way& way = *this->get_member_way(member.ref());
+                    if (intersects(way))
+                    {
+                        inside = true;
+                        break;
+                    }
+                    reference_crossings(way, crossings);
+                }
+                if (!inside && !encloses(crossings))
+                {
+                    return;
+                }
+            }
             // Mark the relation for insertion
             m_matching_ids(osmium::item_type::relation).set(relation.id());
-            const char* admin_level = relation.get_value_by_key(admin_level);
             // Add the way members and their nodes to the output buffer
             for (const auto& member : relation.members())
             {
@@ -140,16 +266,22 @@ namespace handler
 
         void after_way(const osmium::Way& way)
         {
-            // Check if the way describes a valid polygon
-            if (!is_polygon(way))
+            // Check if the way describes a valid polygon and that its
+            // admin_level is contained in the specified filter
+            if (!is_boundary_way(way))
             {
                 return;
             }
-            // Check that the admin_level of the way is contained in the
-            // specified filter
-            if (!osmium::tags::match_any_of(way.tags(), m_filter))
+            // Check that the way intersects or encloses the clip window. The
+            // window test only ever removes ways that qualify without it.
+            if (m_window != nullptr && !intersects(way))
             {
-                return;
+                std::vector<std::size_t> crossings(m_window->references().size(), 0);
+                reference_crossings(way, crossings);
+                if (!encloses(crossings))
+                {
+                    return;
+                }
             }
             // Mark the way for insertion
             m_matching_ids(osmium::item_type::way).set(way.id());
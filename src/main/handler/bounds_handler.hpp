@@ -1,6 +1,7 @@
 #pragma once
 
 #include <osmium/handler.hpp>
+#include <osmium/osm/area.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/node.hpp>
 
@@ -9,6 +10,8 @@ namespace handler
 
     /**
      * A handler that determines the bounding box of an osmium object stream.
+     * The bounds cover the node locations and the outer ring locations of
+     * the areas in the stream.
      */
     class BoundsHandler : public osmium::handler::Handler
     {
@@ -27,6 +30,19 @@ namespace handler
             return m_bounds;
         };
 
+        /* Methods */
+
+        /**
+         * Extend the bounds of this handler with the bounds of another
+         * handler.
+         *
+         * @param other The other handler
+         */
+        void merge(const BoundsHandler& other)
+        {
+            m_bounds.extend(other.bounds());
+        }
+
         /* Osmium functions */
 
         void node(const osmium::Node& node) noexcept
@@ -34,6 +50,19 @@ namespace handler
             m_bounds.extend(node.location());
         }
 
+        void area(const osmium::Area& area) noexcept
+        {
+            // The inner rings are enclosed by the outer rings and can be
+            // skipped
+            for (const osmium::OuterRing& outer : area.outer_rings())
+            {
+                for (const osmium::NodeRef& nr : outer)
+                {
+                    m_bounds.extend(nr.location());
+                }
+            }
+        }
+
     };
 
 }
\ No newline at end of file
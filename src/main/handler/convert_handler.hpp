@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <unordered_map>
 
 #include <osmium/handler.hpp>
 #include <osmium/osm/area.hpp>
@@ -39,6 +40,13 @@ namespace handler
         */
         std::map<object_id_type, Boundary<T>> m_boundaries;
 
+        /**
+         * The transformed points by node id. The borders between neighboring
+         * boundaries are part of both areas, so each shared node is only
+         * transformed once.
+         */
+        std::unordered_map<object_id_type, geometry::Point<T>> m_points;
+
     public:
 
         /* Constructors */
@@ -77,6 +85,14 @@ namespace handler
             geometry::Ring<T> ring;
             for (const osmium::NodeRef& nr : node_refs)
             {
+                // Reuse the point if the node was already transformed
+                auto it = m_points.find(nr.ref());
+                if (it != m_points.end())
+                {
+                    ring.push_back(it->second);
+                    continue;
+                }
+
                 // Apply the transformations on the node
                 T x = nr.lon();
                 T y = nr.lat();
@@ -85,6 +101,7 @@ namespace handler
                     transformation->transform(x, y);
                 }
                 ring.push_back({ x, y });
+                m_points.emplace(nr.ref(), geometry::Point<T>{ x, y });
             }
             return ring;
         }
@@ -71,6 +71,25 @@ namespace handler
             return m_counts;
         };
 
+        /* Methods */
+
+        /**
+         * Add the counts of another handler to the counts of this handler.
+         * Only the types counted by this handler are considered.
+         *
+         * @param other The other handler
+         */
+        void merge(const CountHandler& other)
+        {
+            for (const auto& [type, count] : other.counts())
+            {
+                if (m_types.count(type))
+                {
+                    m_counts.at(type) += count;
+                }
+            }
+        }
+
         /* Osmium Methods */
 
         void osm_object(const osmium::OSMObject& object) noexcept
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <osmium/handler.hpp>
+#include <osmium/osm/way.hpp>
+
+#include "model/types.hpp"
+
+namespace handler
+{
+
+    /**
+     * A handler that sets the node locations of ways from a prebuilt
+     * location index. Unlike osmium::handler::NodeLocationsForWays, the
+     * index is never modified, so it can be shared between multiple
+     * stages.
+     *
+     * Node references without a location in the index receive an invalid
+     * location.
+     */
+    class LocationHandler : public osmium::handler::Handler
+    {
+    protected:
+
+        /* Members */
+
+        const model::location_index_type& m_index;
+
+    public:
+
+        /* Constructors */
+
+        LocationHandler(const model::location_index_type& index) : m_index(index) {}
+
+        /* Osmium Methods */
+
+        void way(osmium::Way& way) const
+        {
+            for (osmium::NodeRef& nr : way.nodes())
+            {
+                nr.set_location(m_index.get_noexcept(nr.positive_ref()));
+            }
+        }
+
+    };
+
+}
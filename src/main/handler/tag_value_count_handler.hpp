@@ -103,6 +103,23 @@ namespace handler
             return m_value_counts;
         };
 
+        /* Methods */
+
+        /**
+         * Add the value counts of another handler to the value counts of
+         * this handler.
+         *
+         * @param other The other handler
+         */
+        void merge(const TagValueCountHandler<T>& other)
+        {
+            m_total += other.total();
+            for (const auto& [value, count] : other.counts())
+            {
+                m_value_counts[value] += count;
+            }
+        }
+
         /* Osmium Methods */
 
         void node(const osmium::Node& node) noexcept
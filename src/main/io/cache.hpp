@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/any_input.hpp>
+
+#include "io/reader/osm_reader.hpp"
+#include "model/clip_window.hpp"
+#include "model/types.hpp"
+#include "util/hash.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace io
+{
+
+    /* Constants */
+
+    /**
+     * The magic bytes at the beginning of each boundary cache file.
+     */
+    const char CACHE_MAGIC[8] = { 'W', 'Z', 'O', 'S', 'M', 'B', 'U', 'F' };
+
+    /**
+     * The version of the boundary cache format. It is part of the cache key,
+     * such that caches of older program versions are never read.
+     */
+    const std::uint32_t CACHE_VERSION = 2;
+
+    /**
+     * The file extension of boundary cache files.
+     */
+    const std::string CACHE_EXTENSION = ".cache";
+
+    /* Functions */
+
+    /**
+     * Calculate the cache key for the boundaries of an input file with the
+     * specified administrative levels. The key is a hash of the file size,
+     * the last modification time, the OSM file header, the read mode, the
+     * levels and the clip window, so it changes whenever the input file, the
+     * filters or the extracted content change. The extracted buffers never
+     * contain metadata, so the metadata flag is not part of the key.
+     *
+     * Only the header block of the input file is decoded.
+     *
+     * @param file_path The input file path
+     * @param mode      The read mode of the extraction
+     * @param levels    The admin_levels of the extracted boundaries
+     * @param clip      The optional clip window
+     * @returns         The cache key as hexadecimal string
+     */
+    std::string cache_key(
+        const fs::path& file_path,
+        read_mode mode,
+        const std::set<model::level_type>& levels,
+        const std::optional<model::ClipWindow>& clip
+    )
+    {
+        util::Hasher hasher;
+        hasher.add(CACHE_VERSION);
+        hasher.add(static_cast<std::uint32_t>(mode));
+        hasher.add(static_cast<std::uint64_t>(fs::file_size(file_path)));
+        hasher.add(static_cast<std::int64_t>(fs::last_write_time(file_path)));
+
+        // Read the header without decoding any objects
+        osmium::io::Reader reader{ osmium::io::File{ file_path.string() }, osmium::osm_entity_bits::nothing };
+        osmium::io::Header header = reader.header();
+        reader.close();
+        for (const auto& [key, value] : header)
+        {
+            hasher.add(key);
+            hasher.add(value);
+        }
+        for (const osmium::Box& box : header.boxes())
+        {
+            hasher.add(box.bottom_left().x());
+            hasher.add(box.bottom_left().y());
+            hasher.add(box.top_right().x());
+            hasher.add(box.top_right().y());
+        }
+
+        hasher.add(levels.size());
+        for (const model::level_type& level : levels)
+        {
+            hasher.add(level);
+        }
+
+        // The coordinates are hashed with their bit patterns
+        auto add_point = [&hasher](const model::geometry::Point<double>& point) {
+            hasher.add(&point.x(), sizeof(double));
+            hasher.add(&point.y(), sizeof(double));
+        };
+        hasher.add(clip.has_value());
+        if (clip.has_value())
+        {
+            add_point(clip->bounds().min());
+            add_point(clip->bounds().max());
+            for (const auto& polygon : clip->polygons().polygons())
+            {
+                hasher.add(polygon.outer().size());
+                for (const auto& point : polygon.outer())
+                {
+                    add_point(point);
+                }
+                for (const auto& inner : polygon.inners())
+                {
+                    hasher.add(inner.size());
+                    for (const auto& point : inner)
+                    {
+                        add_point(point);
+                    }
+                }
+            }
+        }
+        return hasher.hex();
+    }
+
+    /**
+     * Retrieve the path of the boundary cache file for an input file with
+     * the specified administrative levels.
+     *
+     * @param cache_dir The cache directory
+     * @param file_path The input file path
+     * @param mode      The read mode of the extraction
+     * @param levels    The admin_levels of the extracted boundaries
+     * @param clip      The optional clip window
+     * @returns         The cache file path
+     */
+    fs::path cache_path(
+        const fs::path& cache_dir,
+        const fs::path& file_path,
+        read_mode mode,
+        const std::set<model::level_type>& levels,
+        const std::optional<model::ClipWindow>& clip
+    ) {
+        std::string name = file_path.filename().string();
+        name = name.substr(0, name.find('.'));
+        return cache_dir / fs::path(name + "-" + cache_key(file_path, mode, levels, clip) + CACHE_EXTENSION);
+    }
+
+    /**
+     * Remove the least recently used cache files from the cache directory
+     * until their total size does not exceed the specified limit. Cache
+     * files are touched when they are read, so the modification time
+     * reflects the last use. Other files in the directory are ignored.
+     *
+     * @param cache_dir The cache directory
+     * @param max_size  The maximum total size of the cache files in bytes
+     *
+     * Time complexity: Log-Linear
+     */
+    void prune_cache(const fs::path& cache_dir, std::uintmax_t max_size)
+    {
+        std::vector<std::pair<std::time_t, fs::path>> files;
+        std::uintmax_t total = 0;
+        for (const fs::directory_entry& entry : fs::directory_iterator(cache_dir))
+        {
+            if (fs::is_regular_file(entry.path()) && entry.path().extension() == CACHE_EXTENSION)
+            {
+                files.emplace_back(fs::last_write_time(entry.path()), entry.path());
+                total += fs::file_size(entry.path());
+            }
+        }
+
+        // Remove the oldest files first
+        std::sort(files.begin(), files.end());
+        for (const auto& [time, path] : files)
+        {
+            if (total <= max_size)
+            {
+                break;
+            }
+            total -= fs::file_size(path);
+            fs::remove(path);
+        }
+    }
+
+}
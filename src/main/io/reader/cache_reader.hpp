@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <osmium/memory/buffer.hpp>
+
+#include "io/cache.hpp"
+#include "io/reader/reader.hpp"
+
+namespace io
+{
+
+    /**
+     * A reader for boundary cache files. The cache stores the raw contents
+     * of an osmium buffer, so it can be loaded with a single read call and
+     * without decoding any OSM objects.
+     */
+    class CacheReader : public Reader<osmium::memory::Buffer>
+    {
+    public:
+
+        /* Constructors */
+
+        CacheReader(fs::path file_path) : Reader<osmium::memory::Buffer>(file_path) {}
+
+        /* Override Methods */
+
+        osmium::memory::Buffer read() override
+        {
+            std::ifstream ifs{ m_path.string(), std::ios::binary };
+            if (!ifs)
+            {
+                throw std::runtime_error("Cache file '" + m_path.string() + "' could not be opened");
+            }
+
+            // Verify the file header
+            char magic[sizeof(CACHE_MAGIC)];
+            std::uint32_t version = 0;
+            std::uint64_t size = 0;
+            ifs.read(magic, sizeof(magic));
+            ifs.read(reinterpret_cast<char*>(&version), sizeof(version));
+            ifs.read(reinterpret_cast<char*>(&size), sizeof(size));
+            if (!ifs || std::memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || version != CACHE_VERSION)
+            {
+                throw std::runtime_error("Cache file '" + m_path.string() + "' is invalid");
+            }
+            if (size % osmium::memory::align_bytes != 0)
+            {
+                throw std::runtime_error("Cache file '" + m_path.string() + "' is corrupted");
+            }
+
+            // Read the buffer contents directly into the buffer memory
+            osmium::memory::Buffer buffer{
+                std::max<std::size_t>(size, osmium::memory::align_bytes),
+                osmium::memory::Buffer::auto_grow::yes
+            };
+            unsigned char* data = buffer.reserve_space(size);
+            ifs.read(reinterpret_cast<char*>(data), size);
+            if (static_cast<std::uint64_t>(ifs.gcount()) != size)
+            {
+                throw std::runtime_error("Cache file '" + m_path.string() + "' is truncated");
+            }
+            buffer.commit();
+            return buffer;
+        }
+
+    };
+
+}
@@ -0,0 +1,558 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <protozero/pbf_reader.hpp>
+
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
+
+#include "handler/count_handler.hpp"
+#include "handler/tag_value_count_handler.hpp"
+#include "io/reader/reader.hpp"
+#include "model/header.hpp"
+#include "model/types.hpp"
+
+namespace io
+{
+
+    /**
+     * A reader that estimates the header of a PBF file from a stratified
+     * sample of its data blocks.
+     *
+     * The input file must be sorted by object type, so the relations are
+     * stored in a section of trailing blocks. The first block of the
+     * relation section is found with a binary search, which decodes a
+     * logarithmic number of blocks, and the relation section is decoded in
+     * full. The relation, boundary and level counts are therefore exact.
+     *
+     * The preceding node and way section is divided into strata of
+     * consecutive blocks, from which two blocks each are decoded. The node
+     * and way totals are extrapolated with the stratified estimator and the
+     * confidence margins are calculated from the variance of the block
+     * counts within each stratum.
+     *
+     * For more information, refer to
+     * https://wiki.openstreetmap.org/wiki/PBF_Format
+     */
+    class EstimateReader : public Reader<model::Header>
+    {
+    protected:
+
+        /* Types */
+
+        /**
+         * The position of a block in the input file. The block includes
+         * its length prefix and blob header, so it can be copied verbatim
+         * into a new PBF buffer.
+         */
+        struct Block
+        {
+            std::streamoff offset;
+            std::size_t size;
+        };
+
+        /**
+         * The object counts of a single decoded block.
+         */
+        struct Counts
+        {
+            std::size_t nodes = 0;
+            std::size_t ways = 0;
+            std::size_t relations = 0;
+            std::size_t boundaries = 0;
+            std::map<model::level_type, std::size_t> levels;
+        };
+
+        /**
+         * A stratum with the number of blocks it contains and the counts
+         * of its sampled blocks.
+         */
+        struct Stratum
+        {
+            std::size_t blocks;
+            std::vector<Counts> samples;
+        };
+
+        /* Constants */
+
+        /**
+         * The number of sampled blocks per stratum.
+         */
+        const std::size_t SAMPLES_PER_STRATUM = 2;
+
+        /**
+         * The maximum size of a blob header in bytes, as given by the PBF
+         * format specification.
+         */
+        const std::uint32_t MAX_BLOB_HEADER_SIZE = 64 * 1024;
+
+        /**
+         * The z-score for the 95% confidence intervals.
+         */
+        const double Z_SCORE = 1.96;
+
+        /* Members */
+
+        /**
+         * The number of sampled blocks of the node and way section.
+         */
+        std::size_t m_samples = 64;
+
+        /**
+         * The seed for the block selection. A fixed seed makes the estimate
+         * reproducible for the same input file.
+         */
+        std::uint32_t m_seed = 0;
+
+        /**
+         * The number of worker threads. If set to 0, the number of threads
+         * is determined automatically.
+         */
+        int m_threads = 0;
+
+    public:
+
+        /* Constructors */
+
+        EstimateReader(fs::path file_path) : Reader<model::Header>(file_path) {}
+
+        /* Setters */
+
+        void samples(std::size_t samples)
+        {
+            m_samples = std::max(samples, SAMPLES_PER_STRATUM);
+        }
+
+        void seed(std::uint32_t seed)
+        {
+            m_seed = seed;
+        }
+
+        void threads(int threads)
+        {
+            m_threads = threads;
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        /**
+         * Read a fixed number of bytes from the input stream.
+         *
+         * @param ifs  The input stream
+         * @param size The number of bytes
+         * @returns    The bytes
+         * @throws     std::runtime_error if the file ends prematurely
+         */
+        std::string read_bytes(std::ifstream& ifs, std::size_t size) const
+        {
+            std::string data(size, '\0');
+            ifs.read(&data[0], static_cast<std::streamsize>(size));
+            if (static_cast<std::size_t>(ifs.gcount()) != size)
+            {
+                throw std::runtime_error("Unexpected end of file in '" + m_path.string() + "'");
+            }
+            return data;
+        }
+
+        /**
+         * Retrieve the positions of the header block and all data blocks in
+         * the input file. Only the blob headers are read, the blobs
+         * themselves are skipped.
+         *
+         * @param ifs    The input stream
+         * @param header The header block
+         * @returns      The data blocks in file order
+         * @throws       std::runtime_error if the file has no header block
+         *
+         * Time complexity: Linear in the number of blocks
+         */
+        std::vector<Block> scan_blocks(std::ifstream& ifs, Block& header) const
+        {
+            std::vector<Block> blocks;
+            bool has_header = false;
+            unsigned char length_bytes[4];
+            std::streamoff offset = ifs.tellg();
+            while (ifs.read(reinterpret_cast<char*>(length_bytes), sizeof(length_bytes)))
+            {
+                // The blob header size is stored in network byte order
+                const std::uint32_t length = (std::uint32_t(length_bytes[0]) << 24)
+                    | (std::uint32_t(length_bytes[1]) << 16)
+                    | (std::uint32_t(length_bytes[2]) << 8)
+                    | std::uint32_t(length_bytes[3]);
+                if (length > MAX_BLOB_HEADER_SIZE)
+                {
+                    throw std::runtime_error("Invalid blob header size in '" + m_path.string() + "'");
+                }
+
+                // Extract the type and data size from the blob header
+                const std::string blob_header = read_bytes(ifs, length);
+                std::string type;
+                std::size_t size = 0;
+                protozero::pbf_reader reader{ blob_header };
+                while (reader.next())
+                {
+                    switch (reader.tag())
+                    {
+                    case 1:
+                        type = reader.get_string();
+                        break;
+                    case 3:
+                        size = static_cast<std::size_t>(reader.get_int32());
+                        break;
+                    default:
+                        reader.skip();
+                    }
+                }
+
+                ifs.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+                const Block block{ offset, static_cast<std::size_t>(ifs.tellg() - offset) };
+                if (type == "OSMHeader" && !has_header)
+                {
+                    header = block;
+                    has_header = true;
+                }
+                else if (type == "OSMData")
+                {
+                    blocks.push_back(block);
+                }
+                offset = ifs.tellg();
+            }
+            if (!has_header)
+            {
+                throw std::runtime_error("Missing header block in '" + m_path.string() + "'");
+            }
+            return blocks;
+        }
+
+        /**
+         * Decode a data block and count its objects. The block is decoded
+         * through the regular reader from an in-memory PBF buffer, which
+         * consists of the header block of the input file followed by the
+         * data block.
+         *
+         * @param data The header block and the data block
+         * @returns    The object counts
+         */
+        static Counts count_block(const std::string& data)
+        {
+            osmium::io::File file{ data.data(), data.size(), "pbf" };
+            osmium::io::Reader reader{
+                file,
+                osmium::osm_entity_bits::nwr,
+                osmium::io::read_meta::no
+            };
+
+            handler::CountHandler count_handler{
+                osmium::item_type::node,
+                osmium::item_type::way,
+                osmium::item_type::relation
+            };
+            handler::TagValueCountHandler<model::level_type> level_count_handler{
+                "admin_level",
+                osmium::item_type::relation
+            };
+            osmium::apply(reader, count_handler, level_count_handler);
+            reader.close();
+
+            Counts counts;
+            counts.nodes = count_handler.count(osmium::item_type::node);
+            counts.ways = count_handler.count(osmium::item_type::way);
+            counts.relations = count_handler.count(osmium::item_type::relation);
+            counts.boundaries = level_count_handler.total();
+            counts.levels = level_count_handler.counts();
+            return counts;
+        }
+
+        /**
+         * Decode blocks on the worker pool and store their counts. The blobs
+         * are read in file order and blocks that were decoded before are
+         * skipped.
+         *
+         * @param ifs         The input stream
+         * @param blocks      The data blocks
+         * @param header_data The header block, which is prepended to each
+         *                    data block
+         * @param indices     The indices of the blocks to decode
+         * @param decoded     The counts of the decoded blocks by index
+         * @param pool        The worker pool
+         */
+        void decode(
+            std::ifstream& ifs,
+            const std::vector<Block>& blocks,
+            const std::string& header_data,
+            std::vector<std::size_t> indices,
+            std::map<std::size_t, Counts>& decoded,
+            osmium::thread::Pool& pool
+        ) const {
+            std::sort(indices.begin(), indices.end());
+            std::vector<std::pair<std::size_t, std::future<Counts>>> results;
+            for (const std::size_t i : indices)
+            {
+                if (decoded.count(i) > 0)
+                {
+                    continue;
+                }
+                ifs.seekg(blocks[i].offset);
+                std::string data = header_data + read_bytes(ifs, blocks[i].size);
+                results.emplace_back(i, pool.submit(
+                    [data = std::move(data)]() {
+                        return count_block(data);
+                    }
+                ));
+            }
+            for (auto& [i, result] : results)
+            {
+                decoded.emplace(i, result.get());
+            }
+        }
+
+        /**
+         * Estimate the total of a count with the stratified estimator.
+         *
+         * If the samples of a partially read stratum agree, their variance
+         * carries no information about the unread blocks. The variance of
+         * the stratum is then bounded by Popoviciu's inequality over the
+         * range of the count in all sampled blocks, so a stratum that was
+         * not read in full never reports a zero margin unless the count is
+         * constant across all strata.
+         *
+         * @param strata The strata with their sampled block counts
+         * @param value  The accessor for the count of a block
+         * @returns      The estimated total and the margin of its 95%
+         *               confidence interval
+         */
+        std::pair<std::size_t, std::size_t> estimate(
+            const std::vector<Stratum>& strata,
+            const std::function<double(const Counts&)>& value
+        ) const {
+            double minimum = 0.0;
+            double maximum = 0.0;
+            bool first = true;
+            for (const Stratum& stratum : strata)
+            {
+                for (const Counts& counts : stratum.samples)
+                {
+                    minimum = first ? value(counts) : std::min(minimum, value(counts));
+                    maximum = first ? value(counts) : std::max(maximum, value(counts));
+                    first = false;
+                }
+            }
+
+            double total = 0.0;
+            double variance = 0.0;
+            for (const Stratum& stratum : strata)
+            {
+                const double n = static_cast<double>(stratum.samples.size());
+                const double N = static_cast<double>(stratum.blocks);
+                double mean = 0.0;
+                for (const Counts& counts : stratum.samples)
+                {
+                    mean += value(counts);
+                }
+                mean /= n;
+                total += N * mean;
+
+                // The finite population correction is 0 for fully sampled
+                // strata, so only partially sampled strata add variance
+                if (stratum.samples.size() < stratum.blocks)
+                {
+                    double s2 = 0.0;
+                    if (stratum.samples.size() > 1)
+                    {
+                        for (const Counts& counts : stratum.samples)
+                        {
+                            s2 += (value(counts) - mean) * (value(counts) - mean);
+                        }
+                        s2 /= n - 1.0;
+                    }
+                    if (s2 == 0.0)
+                    {
+                        s2 = (maximum - minimum) * (maximum - minimum) / 4.0;
+                    }
+                    variance += N * N * (1.0 - n / N) * s2 / n;
+                }
+            }
+            return {
+                static_cast<std::size_t>(std::llround(total)),
+                static_cast<std::size_t>(std::llround(Z_SCORE * std::sqrt(variance)))
+            };
+        }
+
+    public:
+
+        /* Override Methods */
+
+        model::Header read() override
+        {
+            osmium::io::File file{ m_path.string() };
+            if (file.format() != osmium::io::file_format::pbf)
+            {
+                throw std::invalid_argument("The estimate mode is only available for PBF files");
+            }
+
+            // Use the bounding box of the file header, as the node blocks
+            // are not decoded completely
+            osmium::io::Reader header_reader{ file, osmium::osm_entity_bits::nothing };
+            osmium::Box bounds = header_reader.header().box();
+            header_reader.close();
+
+            // Find the blocks and the header block, which is prepended to
+            // every decoded block
+            std::ifstream ifs{ m_path.string(), std::ios::binary };
+            Block header;
+            std::vector<Block> blocks = scan_blocks(ifs, header);
+            ifs.clear();
+            ifs.seekg(header.offset);
+            const std::string header_data = read_bytes(ifs, header.size);
+
+            osmium::thread::Pool pool{ m_threads };
+            std::map<std::size_t, Counts> decoded;
+
+            // Find the first block of the relation section with a binary
+            // search, as only the trailing blocks of a sorted file contain
+            // relations
+            std::size_t relations_begin = 0;
+            std::size_t relations_end = blocks.size();
+            while (relations_begin < relations_end)
+            {
+                const std::size_t middle = relations_begin + (relations_end - relations_begin) / 2;
+                decode(ifs, blocks, header_data, { middle }, decoded, pool);
+                if (decoded.at(middle).relations > 0)
+                {
+                    relations_end = middle;
+                }
+                else
+                {
+                    relations_begin = middle + 1;
+                }
+            }
+
+            // Decode the relation section in full
+            std::vector<std::size_t> relation_indices;
+            for (std::size_t i = relations_begin; i < blocks.size(); ++i)
+            {
+                relation_indices.push_back(i);
+            }
+            decode(ifs, blocks, header_data, relation_indices, decoded, pool);
+            std::vector<Stratum> relation_strata;
+            if (!relation_indices.empty())
+            {
+                Stratum& stratum = relation_strata.emplace_back(Stratum{ relation_indices.size(), {} });
+                for (const std::size_t i : relation_indices)
+                {
+                    stratum.samples.push_back(decoded.at(i));
+                }
+            }
+
+            // Divide the node and way section into strata of consecutive
+            // blocks and select the sampled blocks of each stratum at random
+            const std::size_t strata_count = std::min(m_samples / SAMPLES_PER_STRATUM, relations_begin);
+            std::mt19937 engine{ m_seed };
+            std::vector<std::vector<std::size_t>> selection(strata_count);
+            std::vector<std::size_t> sampled_indices;
+            for (std::size_t h = 0; h < strata_count; ++h)
+            {
+                const std::size_t first = h * relations_begin / strata_count;
+                const std::size_t last = (h + 1) * relations_begin / strata_count;
+                std::vector<std::size_t> indices(last - first);
+                for (std::size_t i = first; i < last; ++i)
+                {
+                    indices[i - first] = i;
+                }
+                std::sample(
+                    indices.begin(), indices.end(),
+                    std::back_inserter(selection[h]),
+                    SAMPLES_PER_STRATUM,
+                    engine
+                );
+                sampled_indices.insert(sampled_indices.end(), selection[h].begin(), selection[h].end());
+            }
+            decode(ifs, blocks, header_data, sampled_indices, decoded, pool);
+
+            std::vector<Stratum> strata = relation_strata;
+            for (std::size_t h = 0; h < strata_count; ++h)
+            {
+                const std::size_t first = h * relations_begin / strata_count;
+                const std::size_t last = (h + 1) * relations_begin / strata_count;
+                Stratum& stratum = strata.emplace_back(Stratum{ last - first, {} });
+                for (const std::size_t i : selection[h])
+                {
+                    stratum.samples.push_back(decoded.at(i));
+                }
+            }
+
+            // Extrapolate the node and way counts and calculate their
+            // confidence margins. The relation counts are exact, as the
+            // relation section is read in full.
+            auto [nodes, nodes_margin] = estimate(strata, [](const Counts& c) { return double(c.nodes); });
+            auto [ways, ways_margin] = estimate(strata, [](const Counts& c) { return double(c.ways); });
+            auto [relations, relations_margin] = estimate(relation_strata, [](const Counts& c) { return double(c.relations); });
+            auto [boundaries, boundaries_margin] = estimate(relation_strata, [](const Counts& c) { return double(c.boundaries); });
+
+            std::map<model::level_type, std::size_t> levels;
+            std::map<model::level_type, std::size_t> levels_margin;
+            for (const Stratum& stratum : relation_strata)
+            {
+                for (const Counts& counts : stratum.samples)
+                {
+                    for (const auto& [level, count] : counts.levels)
+                    {
+                        levels[level] = 0;
+                    }
+                }
+            }
+            for (auto& [level, count] : levels)
+            {
+                auto [total, margin] = estimate(relation_strata, [level = level](const Counts& c) {
+                    auto it = c.levels.find(level);
+                    return it != c.levels.end() ? double(it->second) : 0.0;
+                });
+                count = total;
+                levels_margin[level] = margin;
+            }
+
+            return model::Header{
+                m_path.string(),
+                file.format(),
+                file.compression(),
+                fs::file_size(m_path),
+                nodes,
+                ways,
+                relations,
+                bounds,
+                boundaries,
+                levels,
+                model::Estimate{
+                    blocks.size(),
+                    decoded.size(),
+                    nodes_margin,
+                    ways_margin,
+                    relations_margin,
+                    boundaries_margin,
+                    levels_margin
+                }
+            };
+        }
+
+    };
+
+}
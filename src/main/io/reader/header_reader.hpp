@@ -1,7 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <deque>
+#include <future>
+#include <optional>
+
 #include <osmium/io/file.hpp>
 #include <osmium/io/reader.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/visitor.hpp>
 
 #include "model/types.hpp"
@@ -14,17 +21,115 @@
 namespace io
 {
 
+    /**
+     * The read modes of the HeaderReader.
+     *
+     * full: All objects of the input file are decoded. The nodes, ways and
+     *       relations are counted and the bounds are calculated from the
+     *       node locations.
+     * fast: Only the relations are decoded for the level distribution. The
+     *       bounds are taken from the file header if present, and the nodes
+     *       and ways are only counted if requested.
+     */
+    enum class header_mode
+    {
+        full,
+        fast
+    };
+
     /**
      * A reader that retrieves general file information for an OSM file.
      */
     class HeaderReader : public Reader<model::Header>
     {
+    protected:
+
+        /* Types */
+
+        /**
+         * The handlers of a single worker. Each decoded block is scanned by
+         * its own set of handlers on the worker pool, the results are merged
+         * into the total afterwards.
+         */
+        struct Shard
+        {
+            // Counts the total number of nodes, ways and relations
+            handler::CountHandler count_handler{
+                osmium::item_type::node,
+                osmium::item_type::way,
+                osmium::item_type::relation
+            };
+
+            // Counts the levels for administrative boundaries
+            handler::TagValueCountHandler<model::level_type> level_count_handler{
+                "admin_level",
+                osmium::item_type::relation
+            };
+
+            // Determines the bounding box of the input
+            handler::BoundsHandler bounds_handler;
+
+            void merge(const Shard& other)
+            {
+                count_handler.merge(other.count_handler);
+                level_count_handler.merge(other.level_count_handler);
+                bounds_handler.merge(other.bounds_handler);
+            }
+        };
+
+        /* Members */
+
+        /**
+         * The read mode.
+         */
+        header_mode m_mode = header_mode::full;
+
+        /**
+         * The object count flag. If set to true, the nodes and ways are
+         * counted in the fast mode as well.
+         */
+        bool m_count = false;
+
+        /**
+         * The bounds flag. If set to false, the bounds are not calculated
+         * in the fast mode if the file header does not contain them.
+         */
+        bool m_bounds = true;
+
+        /**
+         * The number of worker threads. If set to 0, the number of threads
+         * is determined automatically.
+         */
+        int m_threads = 0;
+
     public:
 
         /* Constructors */
 
         HeaderReader(fs::path file_path) : Reader<model::Header>(file_path) {}
 
+        /* Setters */
+
+        void mode(header_mode mode)
+        {
+            m_mode = mode;
+        }
+
+        void count(bool count)
+        {
+            m_count = count;
+        }
+
+        void bounds(bool bounds)
+        {
+            m_bounds = bounds;
+        }
+
+        void threads(int threads)
+        {
+            m_threads = threads;
+        }
+
         /* Override Methods */
 
         model::Header read() override
@@ -32,28 +137,71 @@ namespace io
             // The Reader is initialized here with an osmium::io::File, but could
             // also be directly initialized with a file name.
             osmium::io::File file{ m_path.string() };
-            osmium::io::Reader reader{file};
 
-            // Create the CountHandler that counts the total number of nodes,
-            // ways and relations
-            handler::CountHandler count_handler{
-                osmium::item_type::node,
-                osmium::item_type::way,
-                osmium::item_type::relation
+            // In the fast mode, use the bounding box of the file header if
+            // it is available, such that the node blocks can be skipped
+            osmium::Box header_bounds;
+            if (m_mode == header_mode::fast)
+            {
+                osmium::io::Reader header_reader{ file, osmium::osm_entity_bits::nothing };
+                header_bounds = header_reader.header().box();
+                header_reader.close();
+            }
+
+            // Determine the object types that need to be decoded. The pbf
+            // decoder skips all blocks that only contain other types.
+            const bool count_objects = m_mode == header_mode::full || m_count;
+            const bool calculate_bounds = m_mode == header_mode::full || (m_bounds && !header_bounds.valid());
+            osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::relation;
+            if (count_objects)
+            {
+                entities |= osmium::osm_entity_bits::node | osmium::osm_entity_bits::way;
+            }
+            else if (calculate_bounds)
+            {
+                entities |= osmium::osm_entity_bits::node;
+            }
+            osmium::io::Reader reader{ file, entities, osmium::io::read_meta::no };
+
+            // Scan the decoded blocks on a worker pool, where each block is
+            // passed to its own handlers. The partial results are merged in
+            // the order the blocks were read, while the number of blocks in
+            // flight is bounded to limit the memory usage.
+            osmium::thread::Pool pool{ m_threads };
+            const std::size_t max_blocks = 2 * static_cast<std::size_t>(std::max(pool.num_threads(), 1));
+            std::deque<std::future<Shard>> shards;
+            Shard total;
+
+            auto merge_front = [&]() {
+                total.merge(shards.front().get());
+                shards.pop_front();
             };
 
-            // Create a TagCountHandler that counts the levels for administrative
-            // boundaries
-            handler::TagValueCountHandler<model::level_type> level_count_handler{
-                "admin_level",
-                osmium::item_type::relation 
-            };
-
-            // Create the BoundsHandler that determines the bounding box of the input
-            handler::BoundsHandler bounds_handler;
-
-            // Apply the counters to the input file
-            osmium::apply(reader, count_handler, level_count_handler, bounds_handler);
+            while (osmium::memory::Buffer buffer = reader.read())
+            {
+                shards.push_back(pool.submit(
+                    [calculate_bounds, buffer = std::move(buffer)]() {
+                        Shard shard;
+                        if (calculate_bounds)
+                        {
+                            osmium::apply(buffer, shard.count_handler, shard.level_count_handler, shard.bounds_handler);
+                        }
+                        else
+                        {
+                            osmium::apply(buffer, shard.count_handler, shard.level_count_handler);
+                        }
+                        return shard;
+                    }
+                ));
+                if (shards.size() >= max_blocks)
+                {
+                    merge_front();
+                }
+            }
+            while (!shards.empty())
+            {
+                merge_front();
+            }
 
             // You do not have to close the Reader explicitly, but because the
             // destructor can't throw, you will not see any errors otherwise.
@@ -65,15 +213,19 @@ namespace io
                 file.format(),
                 file.compression(),
                 fs::file_size(m_path),
-                count_handler.count(osmium::item_type::node),
-                count_handler.count(osmium::item_type::way),
-                count_handler.count(osmium::item_type::relation),
-                bounds_handler.bounds(),
-                level_count_handler.total(),
-                level_count_handler.counts()
+                count_objects
+                    ? std::optional<std::size_t>{ total.count_handler.count(osmium::item_type::node) }
+                    : std::nullopt,
+                count_objects
+                    ? std::optional<std::size_t>{ total.count_handler.count(osmium::item_type::way) }
+                    : std::nullopt,
+                total.count_handler.count(osmium::item_type::relation),
+                calculate_bounds ? total.bounds_handler.bounds() : header_bounds,
+                total.level_count_handler.total(),
+                total.level_count_handler.counts()
             };
         }
 
     };
 
-}
\ No newline at end of file
+}
@@ -1,87 +1,255 @@
 #pragma once
 
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <future>
+#include <optional>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/index/map/flex_mem.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/relations/relations_manager.hpp>
 #include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/io/any_input.hpp>
 
 #include "handler/boundary_manager.hpp"
+#include "handler/location_handler.hpp"
 #include "io/reader/reader.hpp"
+#include "model/clip_window.hpp"
 #include "model/types.hpp"
 
 namespace io
 {
 
+    /**
+     * The read modes of the BoundaryReader.
+     *
+     * multi_pass:  The input file is decoded three times (relations, members
+     *              and copy pass). Only the ids of the matching objects are
+     *              kept in memory between the passes.
+     * single_pass: The input file is decoded exactly once. The locations of
+     *              all nodes and the node lists of all ways are kept in
+     *              memory and the boundary relations are resolved against
+     *              them afterwards. The extracted nodes only contain their
+     *              location, and member ways without boundary tags only
+     *              contain their node list. Object metadata is not kept.
+     */
+    enum class read_mode
+    {
+        multi_pass,
+        single_pass
+    };
+
     /**
      * A reader that retrieves the mapdata of an OSM file.
      */
     class BoundaryReader : public Reader<osmium::memory::Buffer>
     {
+    public:
+
+        /* Types */
+
+        /**
+         * The type of the callback that receives the blocks of matching
+         * objects.
+         */
+        using callback_type = std::function<void(osmium::memory::Buffer&&)>;
+
     protected:
 
+        /* Types */
+
+        /**
+         * The type of index used for the node locations in the single pass
+         * mode and for clipping. This must match the include file above
+         */
+        using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+
+        /* Constants */
+
+        /**
+         * The initial size of the in-memory spill buffers in bytes.
+         */
+        const std::size_t SPILL_BUFFER_SIZE = 1024 * 1024;
+
+        /**
+         * The initial size of the filtered block buffers in bytes.
+         */
+        const std::size_t BLOCK_BUFFER_SIZE = 64 * 1024;
+
+        /**
+         * The estimated sizes of the extracted objects in bytes. Node
+         * references and relation members are counted separately, as
+         * every matching node is referenced by roughly one way and every
+         * matching way is a member of roughly one relation. The estimates
+         * only need to be close, the result buffer grows if necessary.
+         */
+        const std::size_t NODE_SIZE_ESTIMATE = 64;
+        const std::size_t NODE_REF_SIZE_ESTIMATE = sizeof(osmium::NodeRef);
+        const std::size_t WAY_SIZE_ESTIMATE = 128;
+        const std::size_t MEMBER_SIZE_ESTIMATE = 32;
+        const std::size_t RELATION_SIZE_ESTIMATE = 1024;
+
+        /* Members */
+
         /**
          * The admin_level filter. Boundaries with an administrative level
          * contained in this set will be kept, while other boundaries will
          * be skipped.
-         * 
+         *
          * OpenStreetMap defines 9 administrative levels from 2 to 11. Yet,
          * it is also possible to use the levels 0, 1 and 12, which are not
          * rendered by default, but need to be considered too.
-         * 
+         *
          * For more information, refer to
          * https://wiki.openstreetmap.org/wiki/Key:admin_level
-         * 
+         *
          */
         std::set<model::level_type> m_levels = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
 
+        /**
+         * The read mode.
+         */
+        read_mode m_mode = read_mode::multi_pass;
+
+        /**
+         * The number of worker threads for the copy pass. If set to 0, the
+         * number of threads is determined automatically.
+         */
+        int m_threads = 0;
+
+        /**
+         * The estimated size of the extracted objects in bytes. It is
+         * computed from the matching ids once the relation membership is
+         * resolved, and is 0 before.
+         */
+        std::size_t m_size_estimate = 0;
+
+        /**
+         * The way filter for the single pass mode. Ways that match this
+         * filter may form boundaries themselves and are stored with their
+         * tags, while all other ways are stored as tag-free node lists.
+         */
+        osmium::TagsFilter m_way_filter{ false };
+
+        /**
+         * The clip window. If set, only boundaries that intersect or enclose
+         * the window are extracted. Clipping keeps the locations of all
+         * nodes in memory during the membership pass.
+         */
+        std::optional<model::ClipWindow> m_clip;
+
+        /**
+         * The metadata flag. If set to false, the object metadata (version,
+         * changeset, timestamp, uid and user) is not decoded, which reduces
+         * the size of the extracted buffers. The single pass mode never
+         * keeps the metadata.
+         */
+        osmium::io::read_meta m_read_meta = osmium::io::read_meta::no;
+
     public:
 
         /* Constructors */
 
-        BoundaryReader(fs::path file_path) : Reader<osmium::memory::Buffer>(file_path) {}
+        BoundaryReader(fs::path file_path) : Reader<osmium::memory::Buffer>(file_path)
+        {
+            init();
+        }
 
         BoundaryReader(fs::path file_path, const std::set<model::level_type>& levels)
-        : Reader<osmium::memory::Buffer>(file_path), m_levels(levels) {}
+        : Reader<osmium::memory::Buffer>(file_path), m_levels(levels)
+        {
+            init();
+        }
 
-        /* Override Methods */
+        /* Setters */
 
-        osmium::memory::Buffer read() override
+        void mode(read_mode mode)
         {
-            osmium::io::File file{m_path.string()};
+            m_mode = mode;
+        }
+
+        void threads(int threads)
+        {
+            m_threads = threads;
+        }
 
-            // Prepare the tag filter for the BoundaryManager with the
-            // specified administrative levels
+        void clip(const model::ClipWindow& window)
+        {
+            m_clip = window;
+        }
+
+        void metadata(bool metadata)
+        {
+            m_read_meta = metadata ? osmium::io::read_meta::yes : osmium::io::read_meta::no;
+        }
+
+        /* Getters */
+
+        std::size_t size_estimate() const
+        {
+            return m_size_estimate;
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        void init()
+        {
+            // Ways with these keys may be closed boundaries themselves, which
+            // are matched by their tags
+            for (const char* key : { "admin_level", "boundary" })
+            {
+                m_way_filter.add_rule(true, key);
+            }
+        }
+
+        /**
+         * Copy a way to a spill buffer with its id and node references only.
+         *
+         * @param buffer The spill buffer
+         * @param way    The way
+         */
+        void spill_node_list(osmium::memory::Buffer& buffer, const osmium::Way& way) const
+        {
+            {
+                osmium::builder::WayBuilder way_builder{ buffer };
+                way_builder.set_id(way.id());
+                osmium::builder::WayNodeListBuilder nodes_builder{ way_builder };
+                for (const osmium::NodeRef& nr : way.nodes())
+                {
+                    nodes_builder.add_node_ref(nr.ref());
+                }
+            }
+            buffer.commit();
+        }
+
+        /**
+         * Prepare the tag filter for the BoundaryManager with the specified
+         * administrative levels.
+         */
+        osmium::TagsFilter level_filter() const
+        {
             osmium::TagsFilter filter{ false };
             for (const model::level_type& level : m_levels)
             {
                 filter.add_rule(true, "admin_level", std::to_string(level));
             }
+            return filter;
+        }
 
-            // Instantiate the boundary filter, which will extract all
-            // administrative boundary relation ids for the specified 
-            // admin_levelsas as well as the associated way and node ids.
-            handler::BoundaryManager manager{ filter };
-
-            // First pass through the file: Read all relations and pass them to
-            // the boundary manager. This will also filter out any relations that
-            // do not match the filter.
-            osmium::relations::read_relations(file, manager);
-
-            // Second pass through the file: Extract the osmium objects through the
-            // reader and pass them to the boundary manager, such that it can mark
-            // the nodes, ways and relations
-            osmium::io::Reader manager_reader{file};
-            osmium::apply(manager_reader, manager.handler());
-            manager.read();
-            manager_reader.close();
-            
-            // Extract the matching ids from the manager and prepare the result buffer
-            auto matching_ids = manager.matching_ids();
-            osmium::memory::Buffer result{file.size(), osmium::memory::Buffer::auto_grow::yes};
-
-            // If there were relations in the input with members that weren't
-            // part of the input file (which often happens for extracts), write
-            // the IDs of the incomplete relations to stderr.
+        /**
+         * If there were relations in the input with members that weren't
+         * part of the input file (which often happens for extracts), write
+         * the number of the incomplete relations to stderr.
+         *
+         * @param manager The boundary manager
+         */
+        void report_incomplete_relations(handler::BoundaryManager& manager) const
+        {
             std::vector<osmium::object_id_type> incomplete_relations_ids;
             manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& handle) {
                 incomplete_relations_ids.push_back(handle->id());
@@ -92,30 +260,399 @@ namespace io
                     << incomplete_relations_ids.size()
                     << " boundaries.\n";
             }
+        }
+
+        /**
+         * Estimate the size of the extracted objects from the number of
+         * matching nodes, ways and relations.
+         *
+         * @param matching_ids The matching node, way and relation ids
+         * @returns            The estimated size in bytes
+         *
+         * Time complexity: Constant
+         */
+        std::size_t estimate_size(const handler::BoundaryManager::nwr_array& matching_ids) const
+        {
+            const std::size_t nodes = matching_ids(osmium::item_type::node).size();
+            const std::size_t ways = matching_ids(osmium::item_type::way).size();
+            const std::size_t relations = matching_ids(osmium::item_type::relation).size();
+            return nodes * (NODE_SIZE_ESTIMATE + NODE_REF_SIZE_ESTIMATE)
+                + ways * (WAY_SIZE_ESTIMATE + MEMBER_SIZE_ESTIMATE)
+                + relations * RELATION_SIZE_ESTIMATE;
+        }
 
-            // Third pass trough the file: Copy the marked object into the result buffer
-            // through yet another reader. using the matching ids found by the boundary
-            // manager.
-            osmium::io::Reader copy_reader{file};
+        /**
+         * Copy the objects of a decoded block that are marked in the
+         * matching ids into a new buffer.
+         *
+         * @param buffer       The decoded block
+         * @param matching_ids The matching node, way and relation ids
+         * @returns            The buffer with the matching objects of the
+         *                     block
+         *
+         * Time complexity: Linear
+         */
+        osmium::memory::Buffer filter_block(
+            const osmium::memory::Buffer& buffer,
+            const handler::BoundaryManager::nwr_array& matching_ids
+        ) const {
+            osmium::memory::Buffer result{ BLOCK_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+            for (const auto& object : buffer.select<osmium::OSMObject>())
+            {
+                if (matching_ids(object.type()).get(object.positive_id()))
+                {
+                    result.add_item(object);
+                    result.commit();
+                }
+            }
+            return result;
+        }
+
+        /**
+         * Collect the nodes of the ways that the boundary manager tests
+         * against the clip window, which are the members of the boundary
+         * relations and the closed boundary ways. This requires an
+         * additional pass through the ways of the input file.
+         *
+         * @param file         The input file
+         * @param manager      The boundary manager
+         * @param member_ways  The way members of the boundary relations
+         * @returns            The ids of the nodes
+         */
+        handler::BoundaryManager::id_set_type clip_nodes(
+            const osmium::io::File& file,
+            const handler::BoundaryManager& manager,
+            const handler::BoundaryManager::id_set_type& member_ways
+        ) const {
+            handler::BoundaryManager::id_set_type nodes;
+            osmium::io::Reader way_reader{ file, osmium::osm_entity_bits::way, osmium::io::read_meta::no };
+            while (osmium::memory::Buffer buffer = way_reader.read())
+            {
+                for (const osmium::Way& way : buffer.select<osmium::Way>())
+                {
+                    if (member_ways.get(way.positive_id()) || manager.is_boundary_way(way))
+                    {
+                        for (const osmium::NodeRef& nr : way.nodes())
+                        {
+                            nodes.set(nr.positive_ref());
+                        }
+                    }
+                }
+            }
+            way_reader.close();
+            return nodes;
+        }
+
+        /**
+         * Read the boundaries with three passes through the input file, or
+         * four passes if a clip window is set.
+         *
+         * @param file     The input file
+         * @param manager  The boundary manager
+         * @param callback The callback that receives the blocks with the
+         *                 matching nodes, ways and relations in order
+         */
+        void stream_multi_pass(const osmium::io::File& file, handler::BoundaryManager& manager, const callback_type& callback)
+        {
+            // First pass through the file: Read all relations and pass them to
+            // the boundary manager. This will also filter out any relations that
+            // do not match the filter. If a clip window is set, the way members of
+            // the boundary relations are collected as well.
+            handler::BoundaryManager::id_set_type member_ways;
+            osmium::io::Reader relation_reader{ file, osmium::osm_entity_bits::relation, osmium::io::read_meta::no };
+            while (osmium::memory::Buffer buffer = relation_reader.read())
+            {
+                osmium::apply(buffer, manager);
+                if (!m_clip.has_value())
+                {
+                    continue;
+                }
+                for (const osmium::Relation& relation : buffer.select<osmium::Relation>())
+                {
+                    if (!manager.new_relation(relation))
+                    {
+                        continue;
+                    }
+                    for (const osmium::RelationMember& member : relation.members())
+                    {
+                        if (member.type() == osmium::item_type::way)
+                        {
+                            member_ways.set(member.positive_ref());
+                        }
+                    }
+                }
+            }
+            relation_reader.close();
+            manager.prepare_for_lookup();
+
+            // Second pass through the file: Extract the osmium objects through the
+            // reader and pass them to the boundary manager, such that it can mark
+            // the nodes, ways and relations. If a clip window is set, the
+            // locations of the nodes of the tested ways are stored and set on the
+            // ways, such that the manager can test the boundaries against the
+            // window. These nodes are found in an additional pass through the ways
+            // beforehand, so the index does not hold every node of the file.
+            osmium::io::Reader manager_reader{ file, osmium::osm_entity_bits::nwr, osmium::io::read_meta::no };
+            if (m_clip.has_value())
+            {
+                const handler::BoundaryManager::id_set_type nodes = clip_nodes(file, manager, member_ways);
+                index_type index;
+                handler::LocationHandler location_handler{ index };
+                manager.clip(&m_clip.value());
+                bool sorted = false;
+                while (osmium::memory::Buffer buffer = manager_reader.read())
+                {
+                    for (const auto& object : buffer.select<osmium::OSMObject>())
+                    {
+                        if (object.type() == osmium::item_type::node && nodes.get(object.positive_id()))
+                        {
+                            index.set(object.positive_id(), static_cast<const osmium::Node&>(object).location());
+                        }
+                        else if (object.type() == osmium::item_type::way && !sorted)
+                        {
+                            // The nodes precede the ways in the file, so the
+                            // index is complete once the first way is read
+                            index.sort();
+                            sorted = true;
+                        }
+                    }
+                    osmium::apply(buffer, location_handler, manager.handler());
+                }
+                manager.read();
+                manager.clip(nullptr);
+            }
+            else
+            {
+                osmium::apply(manager_reader, manager.handler());
+                manager.read();
+            }
+            manager_reader.close();
+
+            // Extract the matching ids from the manager
+            const auto& matching_ids = manager.matching_ids();
+            m_size_estimate = estimate_size(matching_ids);
+
+            report_incomplete_relations(manager);
+
+            // Third pass trough the file: Filter the decoded blocks with the
+            // matching ids found by the boundary manager on a worker pool. Each
+            // worker copies the marked objects of a block into its own buffer.
+            // The filtered blocks are passed to the callback in the order they
+            // were read, while the number of blocks in flight is bounded to
+            // limit the memory usage.
+            osmium::thread::Pool pool{ m_threads };
+            const std::size_t max_blocks = 2 * static_cast<std::size_t>(std::max(pool.num_threads(), 1));
+            std::deque<std::future<osmium::memory::Buffer>> blocks;
+
+            auto emit_front = [&]() {
+                osmium::memory::Buffer block = blocks.front().get();
+                blocks.pop_front();
+                if (block.committed() > 0)
+                {
+                    callback(std::move(block));
+                }
+            };
+
+            osmium::io::Reader copy_reader{ file, osmium::osm_entity_bits::nwr, m_read_meta };
             while (osmium::memory::Buffer buffer = copy_reader.read())
             {
-                // Copy the marked objects
-                for (auto& object : buffer.select<osmium::OSMObject>())
+                blocks.push_back(pool.submit(
+                    [this, &matching_ids, buffer = std::move(buffer)]() {
+                        return filter_block(buffer, matching_ids);
+                    }
+                ));
+                if (blocks.size() >= max_blocks)
+                {
+                    emit_front();
+                }
+            }
+            copy_reader.close();
+            while (!blocks.empty())
+            {
+                emit_front();
+            }
+        }
+
+        /**
+         * Read the boundaries with a single pass through the input file.
+         * The node locations are stored in an index, the node lists of the
+         * ways and the boundary relations are stored in spill buffers while
+         * the file is decoded. Only ways with boundary tags are stored with
+         * their tags. The relation membership is resolved against the spill
+         * buffers afterwards.
+         *
+         * @param file     The input file
+         * @param manager  The boundary manager
+         * @param callback The callback that receives the blocks with the
+         *                 matching nodes, ways and relations in order
+         */
+        void stream_single_pass(const osmium::io::File& file, handler::BoundaryManager& manager, const callback_type& callback)
+        {
+            // The index storing all node locations.
+            index_type index;
+
+            // The spill buffers for the way node lists and the relations.
+            osmium::memory::Buffer ways{ SPILL_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+            osmium::memory::Buffer relations{ SPILL_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+
+            // The only pass through the file: Store the node locations in the
+            // index and copy the ways and the boundary relations to the spill
+            // buffers.
+            osmium::io::Reader reader{ file, osmium::osm_entity_bits::nwr, osmium::io::read_meta::no };
+            while (osmium::memory::Buffer buffer = reader.read())
+            {
+                for (const auto& object : buffer.select<osmium::OSMObject>())
+                {
+                    switch (object.type())
+                    {
+                    case osmium::item_type::node:
+                    {
+                        index.set(object.positive_id(), static_cast<const osmium::Node&>(object).location());
+                        break;
+                    }
+                    case osmium::item_type::way:
+                        if (osmium::tags::match_any_of(object.tags(), m_way_filter))
+                        {
+                            ways.add_item(object);
+                            ways.commit();
+                        }
+                        else
+                        {
+                            spill_node_list(ways, static_cast<const osmium::Way&>(object));
+                        }
+                        break;
+                    case osmium::item_type::relation:
+                        if (manager.new_relation(static_cast<const osmium::Relation&>(object)))
+                        {
+                            relations.add_item(object);
+                            relations.commit();
+                        }
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+            reader.close();
+            index.sort();
+
+            // Resolve the relation membership: Pass the boundary relations to
+            // the manager first and the ways afterwards, such that
+            // it can mark the nodes, ways and relations. If a clip window is
+            // set, the node locations are set on the ways first, such that the
+            // manager can test the boundaries against the window.
+            if (m_clip.has_value())
+            {
+                handler::LocationHandler location_handler{ index };
+                osmium::apply(ways, location_handler);
+                manager.clip(&m_clip.value());
+            }
+            for (const osmium::Relation& relation : relations.select<osmium::Relation>())
+            {
+                manager.relation(relation);
+            }
+            manager.prepare_for_lookup();
+            osmium::apply(ways, manager.handler());
+            manager.read();
+            manager.clip(nullptr);
+
+            report_incomplete_relations(manager);
+
+            // Pass the marked objects to the callback in blocks. The nodes are
+            // restored from the location index without tags.
+            const auto& matching_ids = manager.matching_ids();
+            m_size_estimate = estimate_size(matching_ids);
+            osmium::memory::Buffer block{ BLOCK_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+            auto emit_block = [&](bool force) {
+                if (block.committed() >= BLOCK_BUFFER_SIZE || (force && block.committed() > 0))
+                {
+                    callback(std::move(block));
+                    block = osmium::memory::Buffer{ BLOCK_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+                }
+            };
+            for (const osmium::unsigned_object_id_type id : matching_ids(osmium::item_type::node))
+            {
+                osmium::Location location = index.get_noexcept(id);
+                if (!location.valid())
+                {
+                    // Node is missing in the input
+                    continue;
+                }
+                {
+                    osmium::builder::NodeBuilder node_builder{ block };
+                    node_builder.set_id(static_cast<osmium::object_id_type>(id))
+                        .set_location(location);
+                }
+                block.commit();
+                emit_block(false);
+            }
+            for (const osmium::memory::Buffer* spill : { &ways, &relations })
+            {
+                for (const auto& object : spill->select<osmium::OSMObject>())
                 {
                     if (matching_ids(object.type()).get(object.positive_id()))
                     {
-                        // Copy element to the buffer
-                        result.add_item(object);
-                        result.commit();
+                        block.add_item(object);
+                        block.commit();
+                        emit_block(false);
                     }
                 }
             }
-            copy_reader.close();
+            emit_block(true);
+        }
+
+    public:
+
+        /* Methods */
+
+        /**
+         * Read the boundaries of the input file and pass the matching nodes,
+         * ways and relations to a callback block by block and in order,
+         * without collecting them in a single buffer.
+         *
+         * @param callback The callback that receives the blocks
+         */
+        void stream(const callback_type& callback)
+        {
+            osmium::io::File file{m_path.string()};
+
+            // Instantiate the boundary filter, which will extract all
+            // administrative boundary relation ids for the specified
+            // admin_levelsas as well as the associated way and node ids.
+            handler::BoundaryManager manager{ level_filter() };
 
-            // Close the reader and return the buffer.
-            return std::move(result);
+            if (m_mode == read_mode::single_pass)
+            {
+                stream_single_pass(file, manager, callback);
+            }
+            else
+            {
+                stream_multi_pass(file, manager, callback);
+            }
+        }
+
+        /* Override Methods */
+
+        osmium::memory::Buffer read() override
+        {
+            // Collect the streamed blocks in the result buffer. The size
+            // estimate is known once the first block arrives, so the buffer
+            // is grown to the estimated extract size once instead of being
+            // sized after the input file.
+            osmium::memory::Buffer result{ BLOCK_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes };
+            bool reserved = false;
+            stream([&](osmium::memory::Buffer&& block) {
+                if (!reserved)
+                {
+                    result.grow(std::max(m_size_estimate, block.committed()));
+                    reserved = true;
+                }
+                result.add_buffer(block);
+                result.commit();
+            });
+            return result;
         }
 
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include "io/reader/reader.hpp"
+#include "model/geometry/multipolygon.hpp"
+
+namespace io
+{
+
+    /**
+     * A reader for polygon filter files in the Osmosis polygon format.
+     * Each section of the file is a ring. Sections with a name starting
+     * with '!' are holes of the previous outer ring.
+     *
+     * For more information, refer to
+     * https://wiki.openstreetmap.org/wiki/Osmosis/Polygon_Filter_File_Format
+     */
+    class PolyReader : public Reader<model::geometry::MultiPolygon<double>>
+    {
+    public:
+
+        /* Constructors */
+
+        PolyReader(fs::path file_path) : Reader<model::geometry::MultiPolygon<double>>(file_path) {}
+
+        /* Override Methods */
+
+        model::geometry::MultiPolygon<double> read() override
+        {
+            std::ifstream ifs{ m_path.string() };
+            if (!ifs)
+            {
+                throw std::invalid_argument("Polygon file '" + m_path.string() + "' could not be opened");
+            }
+
+            model::geometry::MultiPolygon<double> result;
+            std::string line;
+
+            // The first line contains the name of the polygon
+            std::getline(ifs, line);
+
+            while (std::getline(ifs, line))
+            {
+                boost::algorithm::trim(line);
+                if (line.empty())
+                {
+                    continue;
+                }
+                if (line == "END")
+                {
+                    // End of the file
+                    break;
+                }
+
+                // Start of a section, read the coordinates until the
+                // section ends
+                const bool hole = line.front() == '!';
+                model::geometry::Ring<double> ring;
+                while (std::getline(ifs, line))
+                {
+                    boost::algorithm::trim(line);
+                    if (line == "END")
+                    {
+                        break;
+                    }
+                    std::istringstream coordinates{ line };
+                    double lon, lat;
+                    if (!(coordinates >> lon >> lat))
+                    {
+                        throw std::invalid_argument("Invalid coordinates '" + line + "' in polygon file '" + m_path.string() + "'");
+                    }
+                    ring.emplace_back(lon, lat);
+                }
+                if (!ring.valid())
+                {
+                    throw std::invalid_argument("Polygon file '" + m_path.string() + "' contains a ring with less than three points");
+                }
+                ring.close();
+
+                if (hole)
+                {
+                    if (result.polygons().empty())
+                    {
+                        throw std::invalid_argument("Polygon file '" + m_path.string() + "' contains a hole without an outer ring");
+                    }
+                    result.polygons().back().inners().push_back(ring);
+                }
+                else
+                {
+                    result.polygons().emplace_back(ring);
+                }
+            }
+
+            if (result.polygons().empty())
+            {
+                throw std::invalid_argument("Polygon file '" + m_path.string() + "' does not contain any polygons");
+            }
+            return result;
+        }
+
+    };
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include <osmium/memory/buffer.hpp>
+
+#include "io/cache.hpp"
+#include "io/writer/writer.hpp"
+
+namespace io
+{
+
+    /**
+     * A writer for boundary cache files. The committed contents of an osmium
+     * buffer are written to a temporary file first, which is renamed to the
+     * cache file afterwards. This way, an interrupted run never leaves a
+     * partially written cache behind.
+     */
+    class CacheWriter : public Writer<osmium::memory::Buffer>
+    {
+    public:
+
+        /* Constructors */
+
+        CacheWriter(fs::path file_path) : Writer<osmium::memory::Buffer>(file_path) {}
+
+        /* Methods */
+
+        /**
+         * Write the committed contents of a buffer to the cache file without
+         * taking ownership of the buffer.
+         *
+         * @param buffer The buffer
+         * @throws       std::runtime_error if the file could not be written
+         */
+        void write(const osmium::memory::Buffer& buffer)
+        {
+            fs::path temp_path = m_path;
+            temp_path += ".tmp";
+            {
+                std::ofstream ofs{ temp_path.string(), std::ios::binary | std::ios::trunc };
+                const std::uint64_t size = buffer.committed();
+                ofs.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+                ofs.write(reinterpret_cast<const char*>(&CACHE_VERSION), sizeof(CACHE_VERSION));
+                ofs.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                ofs.write(reinterpret_cast<const char*>(buffer.data()), size);
+                if (!ofs)
+                {
+                    throw std::runtime_error("Cache file '" + m_path.string() + "' could not be written");
+                }
+            }
+            fs::rename(temp_path, m_path);
+        }
+
+        /* Override Methods */
+
+        void write(osmium::memory::Buffer&& buffer) override
+        {
+            write(static_cast<const osmium::memory::Buffer&>(buffer));
+        }
+
+    };
+
+}
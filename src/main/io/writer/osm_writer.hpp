@@ -10,37 +10,70 @@ namespace io
 {
 
     /**
-     * A reader for API configuration JSON files.
+     * A writer for OSM boundary files. The output file is opened on
+     * construction, such that the boundaries can be written block by block.
      */
     class BoundaryWriter : public Writer<osmium::memory::Buffer>
     {
+    protected:
+
+        /* Members */
+
+        /**
+         * The osmium writer for the output file.
+         */
+        osmium::io::Writer m_writer;
+
+        /* Helper Methods */
+
+        /**
+         * Create the header of the output file.
+         *
+         * @returns The output file header
+         */
+        static osmium::io::Header create_header()
+        {
+            osmium::io::Header header;
+            header.set("generator", "Warzone-OSM-Mapmaker");
+            return header;
+        }
+
     public:
 
         /* Constructors */
 
-        BoundaryWriter(fs::path file_path) : Writer<osmium::memory::Buffer>(file_path) {}
-        
+        BoundaryWriter(fs::path file_path)
+        : Writer<osmium::memory::Buffer>(file_path),
+          m_writer(
+            osmium::io::File{file_path.string()},
+            create_header(),
+            osmium::io::overwrite::allow,
+            osmium::io::fsync::yes
+          ) {}
+
         /* Override Methods */
 
+        /**
+         * Append a buffer to the output file. This may be called multiple
+         * times, the buffers are written in the order they were passed.
+         *
+         * @param buffer The buffer with the nodes, ways and relations
+         */
         void write(osmium::memory::Buffer&& buffer) override
         {
-            osmium::io::File file{m_path.string()};
-            
-            // Create the header and writer
-            osmium::io::Header header;
-            header.set("generator", "Warzone-OSM-Mapmaker");
-            osmium::io::Writer writer{
-                file,
-                header,
-                osmium::io::overwrite::allow, 
-                osmium::io::fsync::yes
-            };
-
-            // Write the buffer to the output file contents
-            writer(std::move(buffer));
-            writer.close();
+            m_writer(std::move(buffer));
+        }
+
+        /* Methods */
+
+        /**
+         * Flush the remaining data and close the output file.
+         */
+        void close()
+        {
+            m_writer.close();
         }
 
     };
 
-}
\ No newline at end of file
+}
@@ -1,11 +1,23 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <set>
+#include <vector>
+
 #include <osmium/osm/area.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
 #include <osmium/area/assembler.hpp>
-#include <osmium/area/multipolygon_manager.hpp>
-#include <osmium/handler/node_locations_for_ways.hpp>
-#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/tags/taglist.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/visitor.hpp>
 
+#include "handler/location_handler.hpp"
+#include "model/boundary_registry.hpp"
 #include "model/types.hpp"
 
 namespace mapmaker
@@ -17,15 +29,24 @@ namespace mapmaker
 
         /* Types */
 
-       /**
-        * The type of index used. This must match the include file above
-        */
-        using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+        /**
+         * An area to assemble, either from a closed way or from a relation
+         * and its member ways.
+         */
+        struct Job
+        {
+            const osmium::Relation* relation;
+            const osmium::Way* way;
+            std::vector<const osmium::Way*> members;
+        };
+
+        /* Constants */
 
         /**
-         * The location handler always depends on the index type
+         * The number of job chunks per worker thread. More chunks than
+         * threads balance the load between areas of very different sizes.
          */
-        using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+        const std::size_t CHUNKS_PER_THREAD = 4;
 
         /* Members */
 
@@ -45,37 +66,109 @@ namespace mapmaker
         std::set<model::level_type> m_levels = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
 
        /**
-        * The split flag. If set to true, the assembled multipolygon areas,
+        * The split levels. The assembled multipolygon areas of these levels,
         * which can contain multiple outer rings are split into polygon areas,
-        * which contain exactly one outer ring (and n inner rings).
+        * which contain exactly one outer ring (and n inner rings). Areas of
+        * other levels are kept as multipolygons.
         */
-        bool m_split;
+        std::set<model::level_type> m_split_levels;
+
+        /**
+         * The node location index of the buffer.
+         */
+        const model::location_index_type& m_index;
+
+        /**
+         * The number of worker threads. If set to 0, the number of threads
+         * is determined automatically.
+         */
+        int m_threads = 0;
 
     public:
 
         /* Constructors */
 
-        Assembler() {}
-        Assembler(const std::set<model::level_type>& levels, bool split = false) : m_levels(levels), m_split(split) {}
+        Assembler(const model::location_index_type& index) : m_index(index) {}
+        Assembler(const std::set<model::level_type>& levels, const model::location_index_type& index, bool split = false)
+            : m_levels(levels), m_split_levels(split ? levels : std::set<model::level_type>{}), m_index(index) {}
+
+        /**
+         * Create an assembler that assembles multiple levels in a single
+         * pass and splits the areas of some of them.
+         *
+         * @param levels       The levels
+         * @param split_levels The levels of which the areas are split
+         * @param index        The node location index of the buffer
+         */
+        Assembler(
+            const std::set<model::level_type>& levels,
+            const std::set<model::level_type>& split_levels,
+            const model::location_index_type& index
+        ) : m_levels(levels), m_split_levels(split_levels), m_index(index) {}
+
+        /* Setters */
+
+        void threads(int threads)
+        {
+            m_threads = threads;
+        }
             
     protected:
 
         /* Helper Methods */
 
+        /**
+         * Check if a closed way forms an area that matches the filter, with
+         * the same rules as the osmium multipolygon manager.
+         *
+         * @param way    The way
+         * @param filter The tag filter
+         * @returns      True if the way forms an area
+         */
+        bool is_area(const osmium::Way& way, const osmium::TagsFilter& filter) const
+        {
+            // At least 4 nodes are needed to make up a polygon
+            if (way.nodes().size() <= 3)
+            {
+                return false;
+            }
+            if (!way.nodes().front().location() || !way.nodes().back().location())
+            {
+                return false;
+            }
+            return way.ends_have_same_location()
+                && !way.tags().has_tag("area", "no")
+                && osmium::tags::match_any_of(way.tags(), filter);
+        }
+
+        /**
+         * Check if a relation is a multipolygon or boundary relation that
+         * matches the filter, with the same rules as the osmium multipolygon
+         * manager.
+         *
+         * @param relation The relation
+         * @param filter   The tag filter
+         * @returns        True if the relation forms an area
+         */
+        bool is_area(const osmium::Relation& relation, const osmium::TagsFilter& filter) const
+        {
+            const char* type = relation.tags().get_value_by_key("type");
+            if (!type)
+            {
+                return false;
+            }
+            return (!std::strcmp(type, "multipolygon") || !std::strcmp(type, "boundary"))
+                && osmium::tags::match_any_of(relation.tags(), filter);
+        }
+
         void create_area_from_ring(osmium::memory::Buffer& buffer, const osmium::Area& area, const osmium::OuterRing& ring, osmium::object_id_type id, std::string name)
         {
-            // Create a new area from the specified outer ring by copying all
-            // attributes and tags from the old area and inserting the inner
-            // rings of the outer ring.
+            // Create a new area from the specified outer ring by copying the
+            // tags from the old area and inserting the inner rings of the
+            // outer ring. The metadata is not used by the map pipeline and
+            // is skipped.
             osmium::builder::AreaBuilder area_builder{ buffer };
-
-            // Copy the area attributes and tags
-            area_builder.set_id(id)
-                .set_version(area.version())
-                .set_changeset(area.changeset())
-                .set_timestamp(area.timestamp())
-                .set_uid(area.uid())
-                .set_user(area.user());
+            area_builder.set_id(id);
 
             // Copy the tags and change the area name
             {
@@ -104,50 +197,138 @@ namespace mapmaker
 
         /* Methods */
 
-        void run(osmium::memory::Buffer& buffer)
+        /**
+         * Assemble the areas of the specified levels from the ways and
+         * relations in the buffer. The areas are stored in a separate
+         * buffer, such that later steps do not have to skip the raw
+         * objects and the raw buffer can be released after the assembly.
+         * The areas are identified by dense boundary ids from the registry,
+         * which is shared between multiple assembly steps.
+         *
+         * @param buffer   The buffer with the ways and relations
+         * @param registry The boundary registry
+         * @returns        The buffer with the assembled areas
+         *
+         * Time complexity: Log-Linear
+         */
+        osmium::memory::Buffer run(osmium::memory::Buffer& buffer, model::BoundaryRegistry& registry)
         {
             // Create the default configuration for the osmium assembler.
             osmium::area::Assembler::config_type config;
 
-            // Prepare the tag filter for the multipolygon manager with the
-            // specified administrative levels.
+            // Prepare the tag filter for the areas with the specified
+            // administrative levels.
             osmium::TagsFilter filter{ false };
             for (const model::level_type& level : m_levels)
             {
                 filter.add_rule(true, "admin_level", std::to_string(level));
             }
 
-            // Initialize the MultipolygonManager. Its job is to collect all
-            // relations and member ways needed for each area. It then calls an
-            // instance of the osmium::area::Assembler class (with the given config)
-            // to actually assemble one area.
-            osmium::area::MultipolygonManager<osmium::area::Assembler> mp_manager{ config, filter };
-
-            // First pass through the buffer: The manager will read all relation
-            // and filter out any relations that do not match the filter.
-            osmium::apply(buffer, mp_manager);
-            mp_manager.prepare_for_lookup();
+            // Add the node locations from the shared index to the ways.
+            handler::LocationHandler location_handler{ m_index };
+            osmium::apply(buffer, location_handler);
 
-            // The index storing all node locations.
-            index_type index;
+            // Collect the ways sorted by id for the member lookup, and the
+            // closed ways that match the filter, which form areas themselves.
+            std::vector<Job> jobs;
+            std::vector<const osmium::Way*> ways;
+            for (const osmium::Way& way : buffer.select<osmium::Way>())
+            {
+                ways.push_back(&way);
+                if (is_area(way, filter))
+                {
+                    jobs.push_back(Job{ nullptr, &way, {} });
+                }
+            }
+            std::sort(ways.begin(), ways.end(), [](const osmium::Way* a, const osmium::Way* b) {
+                return a->id() < b->id();
+            });
 
-            // The handler that stores all node locations in the index and adds them
-            // to the ways.
-            osmium::handler::NodeLocationsForWays<index_type> location_handler{ index };
-            location_handler.ignore_errors();
+            // Collect the boundary relations that match the filter, sorted
+            // by id, and resolve their member ways. Relations with missing
+            // members are skipped.
+            std::vector<const osmium::Relation*> relations;
+            for (const osmium::Relation& relation : buffer.select<osmium::Relation>())
+            {
+                if (is_area(relation, filter))
+                {
+                    relations.push_back(&relation);
+                }
+            }
+            std::sort(relations.begin(), relations.end(), [](const osmium::Relation* a, const osmium::Relation* b) {
+                return a->id() < b->id();
+            });
+            std::vector<osmium::object_id_type> incomplete_relations_ids;
+            for (const osmium::Relation* relation : relations)
+            {
+                Job job{ relation, nullptr, {} };
+                for (const osmium::RelationMember& member : relation->members())
+                {
+                    if (member.type() != osmium::item_type::way)
+                    {
+                        continue;
+                    }
+                    auto it = std::lower_bound(ways.begin(), ways.end(), member.ref(), [](const osmium::Way* way, osmium::object_id_type id) {
+                        return way->id() < id;
+                    });
+                    if (it == ways.end() || (*it)->id() != member.ref())
+                    {
+                        incomplete_relations_ids.push_back(relation->id());
+                        job.relation = nullptr;
+                        break;
+                    }
+                    job.members.push_back(*it);
+                }
+                if (job.relation)
+                {
+                    jobs.push_back(std::move(job));
+                }
+            }
 
-            // Second pass through the buffer: Assemble the filtered boundary
-            // relations into areas.
-            osmium::apply(buffer, location_handler, mp_manager.handler());
-            osmium::memory::Buffer area_buffer = mp_manager.read();
+            // Assemble the areas on a worker pool. The jobs are partitioned
+            // into chunks, each with its own output buffer, and the buffers
+            // are merged in the job order, so the result does not depend on
+            // the number of threads.
+            osmium::thread::Pool pool{ m_threads };
+            const std::size_t chunks = std::min<std::size_t>(
+                std::max<std::size_t>(jobs.size(), 1),
+                CHUNKS_PER_THREAD * static_cast<std::size_t>(std::max(pool.num_threads(), 1))
+            );
+            std::vector<std::future<osmium::memory::Buffer>> results;
+            for (std::size_t c = 0; c < chunks; c++)
+            {
+                const std::size_t first = c * jobs.size() / chunks;
+                const std::size_t last = (c + 1) * jobs.size() / chunks;
+                results.push_back(pool.submit([&, first, last]() {
+                    osmium::memory::Buffer out{ 1024, osmium::memory::Buffer::auto_grow::yes };
+                    for (std::size_t i = first; i < last; i++)
+                    {
+                        // The osmium assembler keeps state, so a new one is
+                        // created for each area
+                        osmium::area::Assembler assembler{ config };
+                        if (jobs[i].way)
+                        {
+                            assembler(*jobs[i].way, out);
+                        }
+                        else
+                        {
+                            assembler(*jobs[i].relation, jobs[i].members, out);
+                        }
+                    }
+                    return out;
+                }));
+            }
+            osmium::memory::Buffer area_buffer{ 1024, osmium::memory::Buffer::auto_grow::yes };
+            for (auto& result : results)
+            {
+                osmium::memory::Buffer out = result.get();
+                area_buffer.add_buffer(out);
+                area_buffer.commit();
+            }
 
             // If there were boundary relations in the input with members that
             //  weren't part of the input file (which often happens for extracts),
             // write the IDs of the incomplete relations to stderr.
-            std::vector<osmium::object_id_type> incomplete_relations_ids;
-            mp_manager.for_each_incomplete_relation([&](const osmium::relations::RelationHandle& handle) {
-                incomplete_relations_ids.push_back(handle->id());
-                });
             if (!incomplete_relations_ids.empty())
             {
                 std::cerr << "[Warning] Skipped missing members for "
@@ -155,11 +336,15 @@ namespace mapmaker
                           << " boundaries.\n";
             }
       
-            // Add the assembled areas from the area buffer to the input buffer
-            std::size_t offset = 0;
+            // Move the assembled areas to the area store and split the areas
+            // of the split levels by their outer rings. Each resulting area
+            // is registered with a dense boundary id, which replaces its OSM
+            // area id. See BoundaryRegistry for the consequences.
+            osmium::memory::Buffer areas{ 1024, osmium::memory::Buffer::auto_grow::yes };
             for (const osmium::Area& area : area_buffer.select<osmium::Area>())
             {
-                if (m_split)
+                const char* level = area.get_value_by_key("admin_level", "0");
+                if (m_split_levels.count(static_cast<model::level_type>(std::atoi(level))))
                 {
                     // Retrieve the area name
                     std::string name = area.get_value_by_key("name", "");
@@ -169,9 +354,8 @@ namespace mapmaker
                     }
                     if (area.outer_rings().size() == 1)
                     {
-                        create_area_from_ring(buffer, area, *area.outer_rings().begin(), area.id() * (offset + 1), name);
-                        buffer.commit();
-                        ++offset;
+                        create_area_from_ring(areas, area, *area.outer_rings().begin(), registry.add(area.id()), name);
+                        areas.commit();
                     }
                     else
                     {
@@ -179,19 +363,19 @@ namespace mapmaker
                         std::size_t i = 1;
                         for (const osmium::OuterRing& outer : area.outer_rings())
                         {
-                            create_area_from_ring(buffer, area, outer, area.id() * (offset + 1), name + ' ' + std::to_string(i));
-                            buffer.commit();
+                            create_area_from_ring(areas, area, outer, registry.add(area.id()), name + ' ' + std::to_string(i));
+                            areas.commit();
                             ++i;
-                            ++offset;
                         }
                     }
                 }
                 else
                 {
-                    buffer.add_item(area);
-                    buffer.commit();
+                    areas.add_item(area).set_id(registry.add(area.id()));
+                    areas.commit();
                 }
             }
+            return areas;
         }
 
     };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "util/color.hpp"
 #include "util/rand.hpp"
 
@@ -27,7 +29,11 @@ namespace mapmaker
 
         std::map<object_id_type, std::set<object_id_type>> m_hierarchy = {};
 
-        std::map<object_id_type, object_id_type> m_ids = {};
+        /**
+         * The territory, bonus or super bonus id of each boundary, indexed by
+         * the dense boundary id.
+         */
+        std::vector<object_id_type> m_ids = {};
 
     public:
 
@@ -207,8 +213,9 @@ namespace mapmaker
                 translate(boundary.center);
             }
 
-            // Fill the id map, which maps the boundary ids to territory, bonus
-            // and super bonus ids.
+            // Fill the id table, which maps the dense boundary ids to territory,
+            // bonus and super bonus ids.
+            m_ids.assign(boundaries.empty() ? 0 : static_cast<std::size_t>(boundaries.rbegin()->first) + 1, 0);
             object_id_type t = 1;
             object_id_type b = 1;
             object_id_type s = 1;
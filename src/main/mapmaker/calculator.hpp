@@ -26,7 +26,7 @@ namespace mapmaker
         geometry::Rectangle<T> run(const osmium::memory::Buffer& buffer) const
         {
             // Prepare the bounds handler that calculates the minimum bounding
-            // box over all nodes in the buffer
+            // box over all nodes and area rings in the buffer
             handler::BoundsHandler bounds_handler{};
             osmium::apply(buffer, bounds_handler);
             // Retrieve the calculated bounds and convert them to a rectangle
@@ -1,38 +1,113 @@
 #pragma once
 
-#include <map>
-#include <set>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
-#include <osmium/builder/osm_object_builder.hpp>
-#include <osmium/handler/node_locations_for_ways.hpp>
-#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/osm/relation.hpp>
 #include <osmium/osm/types.hpp>
+#include <osmium/thread/pool.hpp>
 
-#include "handler/compression_handler.hpp"
+#include "functions/distance.hpp"
+#include "functions/intersect.hpp"
+#include "functions/simplify.hpp"
+#include "functions/transform.hpp"
+#include "mapmaker/purger.hpp"
+#include "model/geometry/line.hpp"
+#include "model/geometry/point.hpp"
+#include "model/geometry/rectangle.hpp"
+#include "model/geometry/segment.hpp"
+#include "model/node_index.hpp"
+#include "model/segment_grid.hpp"
+#include "model/topology.hpp"
+#include "model/types.hpp"
 
 namespace mapmaker
 {
 
+    /**
+     * The line simplification algorithms of the compressor.
+     *
+     * dp: The Douglas-Peucker algorithm, which removes points closer than the
+     *     tolerance to the simplified line.
+     * vw: The Visvalingam-Whyatt algorithm, which removes points with an
+     *     effective area smaller than the squared tolerance. Unlike
+     *     Douglas-Peucker, its worst case is log-linear.
+     */
+    enum class simplify_mode
+    {
+        dp,
+        vw
+    };
+
     class Compressor
     {
     protected:
 
-        /* Types */
+        /* Constants */
 
-       /**
-        * The type of index used. This must match the include file above
-        */
-        using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+        /**
+         * The number of arc chunks per worker thread. More chunks than
+         * threads balance the load between arcs of very different lengths.
+         */
+        const std::size_t CHUNKS_PER_THREAD = 4;
 
         /**
-         * The location handler always depends on the index type
+         * The estimated number of bytes per point in the map file, which
+         * holds the coordinates with 4 significant digits.
          */
-        using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+        const std::size_t BYTES_PER_POINT = 12;
 
         /* Members */
 
         double m_tolerance;
 
+        /**
+         * The shared-arc topology of the ways in the buffer.
+         */
+        const model::Topology& m_topology;
+
+        /**
+         * The number of worker threads. If set to 0, the number of threads
+         * is determined automatically.
+         */
+        int m_threads;
+
+        /**
+         * The simplification algorithm.
+         */
+        simplify_mode m_mode = simplify_mode::dp;
+
+        /**
+         * The maximum number of nodes after the compression. If set to 0,
+         * the number of nodes is not limited.
+         */
+        std::size_t m_max_points = 0;
+
+        /**
+         * The maximum estimated size of the coordinates in the map file. If
+         * set to 0, the size is not limited.
+         */
+        std::size_t m_max_bytes = 0;
+
+        /**
+         * The transformations that are applied on the node locations before
+         * the simplification. If empty, the ways are simplified in degrees.
+         */
+        std::vector<std::shared_ptr<functions::Transformation<double>>> m_projection;
+
+        /**
+         * The topology preservation flag. If set to true, removed points are
+         * restored until the simplified borders do not cross.
+         */
+        bool m_preserve_topology = false;
+
     public:
 
         /* Constructors */
@@ -45,120 +120,584 @@ namespace mapmaker
          * For more information on finding a good tolerance value, refer
          * to https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
          *
-         * @param tolerance The distance epsilon for the Douglas-Peucker-Algorithm.
+         * @param tolerance The distance epsilon in degrees, or in the projected
+         *                  units if a projection is set
+         * @param topology  The shared-arc topology of the buffer
+         * @param threads   The number of worker threads, 0 for automatic
          *
          * Time complexity: Log-Linear (Average-case), Quadratic (Worst-case)
          */
-        Compressor(double tolerance) : m_tolerance(tolerance) {}
-            
-        /* Methods */
+        Compressor(double tolerance, const model::Topology& topology, int threads = 0)
+            : m_tolerance(tolerance), m_topology(topology), m_threads(threads) {}
 
-        void run(osmium::memory::Buffer& buffer)
+        /* Setters */
+
+        void mode(simplify_mode mode)
         {
-            // If the tolerance is less or equal to zero,
-            // no compression will be applied.
-            if (m_tolerance <= 0)
+            m_mode = mode;
+        }
+
+        void projection(const std::vector<std::shared_ptr<functions::Transformation<double>>>& transformations)
+        {
+            m_projection = transformations;
+        }
+
+        void preserve_topology(bool preserve)
+        {
+            m_preserve_topology = preserve;
+        }
+
+        void max_points(std::size_t points)
+        {
+            m_max_points = points;
+        }
+
+        void max_bytes(std::size_t bytes)
+        {
+            m_max_bytes = bytes;
+        }
+
+        /* Accessors */
+
+        /**
+         * Retrieve the applied tolerance, which is raised by run() if the
+         * tolerance does not meet the point or byte budget.
+         */
+        double tolerance() const noexcept
+        {
+            return m_tolerance;
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        /**
+         * Simplify a line with the selected algorithm.
+         *
+         * @param line The line
+         * @returns    The flags that indicate which points of the line
+         *             are kept
+         */
+        std::vector<bool> simplify(const model::geometry::Line<double>& line) const
+        {
+            if (m_mode == simplify_mode::vw)
             {
-                return;
+                // Compare the effective areas with the squared tolerance,
+                // such that the tolerance remains a distance for both modes
+                return functions::visvalingam_whyatt(line, m_tolerance * m_tolerance);
             }
+            return functions::douglas_peucker(line, m_tolerance);
+        }
 
-            // Calculate the degrees for each node in the input buffer. The
-            // resulting map will indicate which nodes should be ignored during
-            // the compression process in order to avoid the creation of holes
-            // between boundaries.
-            std::map<osmium::object_id_type, std::size_t> node_degrees{};
-            for (const osmium::Way& way : buffer.select<osmium::Way>())
+        /**
+         * Calculate the importance of the points of a line with the selected
+         * algorithm. A point is kept by simplify() exactly if its importance
+         * is greater than the tolerance.
+         *
+         * @param line The line
+         * @returns    The importance of each point
+         */
+        std::vector<double> importance(const model::geometry::Line<double>& line) const
+        {
+            if (m_mode == simplify_mode::vw)
             {
-                for (const osmium::NodeRef& nr : way.nodes())
+                std::vector<double> areas = functions::effective_areas(line);
+                for (double& area : areas)
                 {
-                    // Check if node entry exists in the count map
-                    auto it = node_degrees.find(nr.ref());
-                    if (it == node_degrees.end())
+                    area = std::sqrt(area);
+                }
+                return areas;
+            }
+            return functions::split_distances(line);
+        }
+
+        /**
+         * Retrieve the line of an arc from the node locations and apply the
+         * projection on it.
+         *
+         * @param arc  The arc
+         * @param line The line that is overwritten with the arc locations
+         */
+        void arc_line(const std::vector<std::size_t>& arc, model::geometry::Line<double>& line) const
+        {
+            line.clear();
+            for (const std::size_t n : arc)
+            {
+                const osmium::Location& location = m_topology.locations[n];
+                double x = location.lon();
+                double y = location.lat();
+                for (const auto& transformation : m_projection)
+                {
+                    transformation->transform(x, y);
+                }
+                line.push_back({ x, y });
+            }
+        }
+
+        /**
+         * Calculate the number of references of each arc by the relation
+         * members in the buffer. Each reference writes the arc once into the
+         * map file.
+         *
+         * @param buffer The buffer
+         * @returns      The number of references of each arc, at least 1
+         *
+         * Time complexity: Log-Linear
+         */
+        std::vector<std::size_t> arc_weights(const osmium::memory::Buffer& buffer) const
+        {
+            std::vector<model::object_id_type> members;
+            for (const osmium::Relation& relation : buffer.select<osmium::Relation>())
+            {
+                for (const osmium::RelationMember& member : relation.members())
+                {
+                    if (member.type() == osmium::item_type::way)
                     {
-                        it = node_degrees.insert(it, { nr.ref(), 0 });
+                        members.push_back(member.ref());
                     }
-                    it->second += 1;
                 }
             }
+            std::sort(members.begin(), members.end());
 
-            // Ignore nodes that have more than two neighbors.
-            std::set<osmium::object_id_type> ignored_nodes;
-            for (const auto& [id, degree] : node_degrees)
+            std::vector<std::size_t> weights(m_topology.arcs.size(), 0);
+            for (std::size_t w = 0; w < m_topology.ways.size(); w++)
             {
-                if (degree > 2)
+                auto [first, last] = std::equal_range(members.begin(), members.end(), m_topology.ways[w]);
+                for (const model::ArcRef& ref : m_topology.way_arcs[w])
                 {
-                    ignored_nodes.insert(id);
+                    weights[ref.arc] += static_cast<std::size_t>(last - first);
                 }
             }
+            for (std::size_t& weight : weights)
+            {
+                weight = std::max<std::size_t>(weight, 1);
+            }
+            return weights;
+        }
 
-            // The index storing all node locations.
-            index_type index;
+        /**
+         * Select the smallest tolerance, such that the total cost of the
+         * kept points does not exceed a budget. The importance values are
+         * sorted once and the number of affordable points is found with a
+         * binary search over the accumulated costs.
+         *
+         * @param points The importance and cost of each removable point
+         * @param fixed  The cost of the points that are always kept
+         * @param budget The budget
+         * @returns      The tolerance
+         *
+         * Time complexity: Log-Linear
+         */
+        double select_tolerance(std::vector<std::pair<double, std::size_t>> points, std::size_t fixed, std::size_t budget) const
+        {
+            std::sort(points.begin(), points.end(), std::greater<std::pair<double, std::size_t>>());
+            std::vector<std::size_t> costs(points.size());
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < points.size(); i++)
+            {
+                total += points[i].second;
+                costs[i] = total;
+            }
 
-            // The handler that stores all node locations in the index and adds them
-            // to the ways.
-            osmium::handler::NodeLocationsForWays<index_type> location_handler{ index };
-            location_handler.ignore_errors();
+            // Keep the most important points that fit into the budget, all
+            // points with the importance of the first excluded point are
+            // removed as well
+            const std::size_t available = budget > fixed ? budget - fixed : 0;
+            const std::size_t k = std::upper_bound(costs.begin(), costs.end(), available) - costs.begin();
+            return k < points.size() ? points[k].first : 0.0;
+        }
 
-            // Compress the ways in the buffer using the Douglas-Peucker
-            // algorithm and retrieve the set of removed node ids.
-            handler::CompressionHandler compression_handler{ m_tolerance, ignored_nodes };
-            osmium::apply(buffer, location_handler, compression_handler);
-            std::set<osmium::object_id_type> removed_nodes = compression_handler.removed_nodes();
+        /**
+         * Calculate the importance of the points of all arcs on the worker
+         * pool and raise the tolerance to meet the point and byte budgets.
+         *
+         * @param buffer The buffer
+         * @param pool   The worker pool
+         * @returns      The flags of the kept points of each arc
+         */
+        std::vector<std::vector<bool>> select_by_budget(const osmium::memory::Buffer& buffer, osmium::thread::Pool& pool)
+        {
+            const model::Topology& topology = m_topology;
+            std::vector<std::vector<double>> importances(topology.arcs.size());
+            for_each_chunk(pool, [&](std::size_t first, std::size_t last) {
+                model::geometry::Line<double> line;
+                for (std::size_t a = first; a < last; a++)
+                {
+                    arc_line(topology.arcs[a], line);
+                    importances[a] = importance(line);
+                }
+            });
 
-            // Create a new buffer by copying the objects from the old buffer
-            // while ignoring nodes that were marked as removed by the
-            // compression handler.
-            osmium::memory::Buffer result{ 1024, osmium::memory::Buffer::auto_grow::yes };
-            for (const auto& object : buffer.select<osmium::OSMObject>())
+            // The junctions are always kept. In the map file, every arc
+            // reference repeats the inner points and one end point.
+            const std::vector<std::size_t> weights = arc_weights(buffer);
+            std::vector<std::pair<double, std::size_t>> points;
+            std::vector<std::pair<double, std::size_t>> bytes;
+            std::size_t fixed_points = 0;
+            std::size_t fixed_bytes = 0;
+            for (const bool junction : topology.junctions)
             {
-                switch (object.type())
+                fixed_points += junction;
+            }
+            for (std::size_t a = 0; a < topology.arcs.size(); a++)
+            {
+                fixed_bytes += weights[a] * BYTES_PER_POINT;
+                for (std::size_t i = 1; i + 1 < importances[a].size(); i++)
                 {
-                case osmium::item_type::node:
-                    // Copy the node if it was not marked as removed
-                    if (!removed_nodes.count(object.id()))
+                    points.emplace_back(importances[a][i], 1);
+                    bytes.emplace_back(importances[a][i], weights[a] * BYTES_PER_POINT);
+                }
+            }
+            if (m_max_points > 0)
+            {
+                m_tolerance = std::max(m_tolerance, select_tolerance(std::move(points), fixed_points, m_max_points));
+            }
+            if (m_max_bytes > 0)
+            {
+                m_tolerance = std::max(m_tolerance, select_tolerance(std::move(bytes), fixed_bytes, m_max_bytes));
+            }
+
+            // Keep the points that are more important than the selected
+            // tolerance
+            std::vector<std::vector<bool>> kept(topology.arcs.size());
+            for (std::size_t a = 0; a < topology.arcs.size(); a++)
+            {
+                kept[a].resize(importances[a].size());
+                for (std::size_t i = 0; i < importances[a].size(); i++)
+                {
+                    kept[a][i] = importances[a][i] > m_tolerance;
+                }
+            }
+            return kept;
+        }
+
+        /**
+         * Simplify all arcs on the worker pool with the tolerance.
+         *
+         * @param pool The worker pool
+         * @returns    The flags of the kept points of each arc
+         */
+        std::vector<std::vector<bool>> simplify_arcs(osmium::thread::Pool& pool) const
+        {
+            const model::Topology& topology = m_topology;
+            std::vector<std::vector<bool>> kept(topology.arcs.size());
+            for_each_chunk(pool, [&](std::size_t first, std::size_t last) {
+                model::geometry::Line<double> line;
+                for (std::size_t a = first; a < last; a++)
+                {
+                    arc_line(topology.arcs[a], line);
+                    kept[a] = simplify(line);
+                }
+            });
+            return kept;
+        }
+
+        /**
+         * Calculate the number of points and bytes of the kept points with
+         * the same costs that are used for the budget selection.
+         *
+         * @param buffer The buffer
+         * @param kept   The flags of the kept points of each arc
+         * @returns      The number of points and the number of bytes
+         *
+         * Time complexity: Linear
+         */
+        std::pair<std::size_t, std::size_t> budget_costs(const osmium::memory::Buffer& buffer, const std::vector<std::vector<bool>>& kept) const
+        {
+            const std::vector<std::size_t> weights = arc_weights(buffer);
+            std::size_t points = 0;
+            std::size_t bytes = 0;
+            for (const bool junction : m_topology.junctions)
+            {
+                points += junction;
+            }
+            for (std::size_t a = 0; a < kept.size(); a++)
+            {
+                std::size_t inner = 0;
+                for (std::size_t i = 1; i + 1 < kept[a].size(); i++)
+                {
+                    inner += kept[a][i];
+                }
+                points += inner;
+                bytes += weights[a] * BYTES_PER_POINT * (inner + 1);
+            }
+            return { points, bytes };
+        }
+
+        /**
+         * Restore removed points until no simplified segment crosses another
+         * simplified segment.
+         *
+         * The simplified segments of all arcs are indexed in a segment grid,
+         * such that each segment is only tested against nearby segments.
+         * Each segment that crosses another segment is split at the removed
+         * point with the greatest distance to it. This is repeated until no
+         * crossings are left that can be resolved, which removes both self
+         * intersections of rings and crossings between neighboring borders.
+         * Crossings of segments from the original data are kept.
+         *
+         * @param kept The flags of the kept points of each arc
+         *
+         * Time complexity: Linear (Average-case)
+         */
+        void restore_crossings(std::vector<std::vector<bool>>& kept) const
+        {
+            const model::Topology& topology = m_topology;
+
+            // Retrieve the lines of all arcs and their bounds once
+            std::vector<model::geometry::Line<double>> lines(topology.arcs.size());
+            model::geometry::Rectangle<double> bounds{
+                std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()
+            };
+            for (std::size_t a = 0; a < topology.arcs.size(); a++)
+            {
+                arc_line(topology.arcs[a], lines[a]);
+                for (const model::geometry::Point<double>& p : lines[a])
+                {
+                    bounds.min() = { std::min(bounds.min().x(), p.x()), std::min(bounds.min().y(), p.y()) };
+                    bounds.max() = { std::max(bounds.max().x(), p.x()), std::max(bounds.max().y(), p.y()) };
+                }
+            }
+
+            // A simplified segment between two kept points of an arc
+            struct Piece
+            {
+                std::size_t arc;
+                std::size_t first;
+                std::size_t last;
+            };
+
+            // Collect and index the simplified segments once. Split segments
+            // are marked as dead and stay in the grid, where queries skip
+            // them.
+            std::vector<Piece> segments;
+            for (std::size_t a = 0; a < topology.arcs.size(); a++)
+            {
+                std::size_t first = 0;
+                for (std::size_t i = 1; i < kept[a].size(); i++)
+                {
+                    if (kept[a][i])
                     {
-                        result.add_item(object);
-                        result.commit();
+                        segments.push_back({ a, first, i });
+                        first = i;
                     }
-                    break;
-                case osmium::item_type::way:
+                }
+            }
+            std::vector<bool> alive(segments.size(), true);
+            std::vector<bool> crossing(segments.size(), false);
+            model::SegmentGrid<double> grid{ bounds, segments.size() };
+            for (std::size_t s = 0; s < segments.size(); s++)
+            {
+                const Piece& segment = segments[s];
+                grid.insert(s, lines[segment.arc][segment.first], lines[segment.arc][segment.last]);
+            }
+
+            // The first round tests all segments, later rounds only test the
+            // segments created by the previous round, as the crossings of the
+            // other segments can only change with them. Each round restores
+            // at least one removed point, and each segment is tested once
+            // when it is created, so the total work over all rounds is linear
+            // in the number of points of the arcs.
+            std::vector<std::size_t> pending(segments.size());
+            for (std::size_t s = 0; s < segments.size(); s++)
+            {
+                pending[s] = s;
+            }
+            while (!pending.empty())
+            {
+                // Find the segments that cross a pending segment and mark
+                // both. Segments that share a node only touch and are
+                // skipped.
+                std::vector<std::size_t> marked;
+                auto mark = [&](std::size_t s) {
+                    if (!crossing[s])
                     {
-                        // Copy the way and rebuild the node reference list
-                        // while ignoring the removed node references.
-                        osmium::builder::WayBuilder way_builder{ result };
-
-                        // Copy the way attributes and tags
-                        way_builder.set_id(object.id())
-                            .set_version(object.version())
-                            .set_changeset(object.changeset())
-                            .set_timestamp(object.timestamp())
-                            .set_uid(object.uid())
-                            .set_user(object.user())
-                            .add_item(object.tags());
-
-                        // Copy the node references and filter the compressed nodes
+                        crossing[s] = true;
+                        marked.push_back(s);
+                    }
+                };
+                for (const std::size_t s : pending)
+                {
+                    const Piece segment = segments[s];
+                    const model::geometry::Segment<double> s1{ lines[segment.arc][segment.first], lines[segment.arc][segment.last] };
+                    const std::size_t s1_first = topology.arcs[segment.arc][segment.first];
+                    const std::size_t s1_last = topology.arcs[segment.arc][segment.last];
+                    grid.query(s1.first(), s1.last(), [&](std::size_t t) {
+                        if (t == s || !alive[t] || (crossing[s] && crossing[t]))
                         {
-                            const osmium::Way& way = static_cast<const osmium::Way&>(object);
-                            osmium::builder::WayNodeListBuilder way_nodes_builder{ way_builder };
-                            for (const osmium::NodeRef& nr : way.nodes())
-                            {
-                                if (!removed_nodes.count(nr.ref()))
-                                {
-                                    way_nodes_builder.add_node_ref(nr.ref());
-                                }
-                            }
+                            return;
                         }
+                        const Piece& other = segments[t];
+                        const std::size_t s2_first = topology.arcs[other.arc][other.first];
+                        const std::size_t s2_last = topology.arcs[other.arc][other.last];
+                        if (s1_first == s2_first || s1_first == s2_last || s1_last == s2_first || s1_last == s2_last)
+                        {
+                            return;
+                        }
+                        const model::geometry::Segment<double> s2{ lines[other.arc][other.first], lines[other.arc][other.last] };
+                        if (functions::segments_cross(s1, s2))
+                        {
+                            mark(s);
+                            mark(t);
+                        }
+                    });
+                }
+
+                // Restore the farthest removed point of each crossing segment
+                // and replace the segment with its two halves
+                std::vector<std::size_t> created;
+                for (const std::size_t s : marked)
+                {
+                    crossing[s] = false;
+                    const Piece segment = segments[s];
+                    if (segment.last - segment.first < 2)
+                    {
+                        continue;
+                    }
+                    const model::geometry::Line<double>& line = lines[segment.arc];
+                    std::size_t index = segment.first + 1;
+                    double d_max = -1.0;
+                    for (std::size_t i = segment.first + 1; i < segment.last; i++)
+                    {
+                        double d = functions::perpendicular_distance(line[i], line[segment.first], line[segment.last]);
+                        if (d > d_max)
+                        {
+                            index = i;
+                            d_max = d;
+                        }
+                    }
+                    kept[segment.arc][index] = true;
+                    alive[s] = false;
+                    for (const Piece& half : { Piece{ segment.arc, segment.first, index }, Piece{ segment.arc, index, segment.last } })
+                    {
+                        const std::size_t id = segments.size();
+                        segments.push_back(half);
+                        alive.push_back(true);
+                        crossing.push_back(false);
+                        grid.insert(id, line[half.first], line[half.last]);
+                        created.push_back(id);
+                    }
+                }
+                pending.swap(created);
+            }
+        }
+
+        /**
+         * Partition the arcs into chunks and process them on the worker pool.
+         * The function is called with the first and the past-the-end arc
+         * index of each chunk and must only write to per-arc results.
+         *
+         * @param pool     The worker pool
+         * @param function The chunk function
+         */
+        template <typename F>
+        void for_each_chunk(osmium::thread::Pool& pool, F&& function) const
+        {
+            const std::size_t arcs = m_topology.arcs.size();
+            const std::size_t chunks = std::min<std::size_t>(
+                std::max<std::size_t>(arcs, 1),
+                CHUNKS_PER_THREAD * static_cast<std::size_t>(std::max(pool.num_threads(), 1))
+            );
+            std::vector<std::future<void>> results;
+            for (std::size_t c = 0; c < chunks; c++)
+            {
+                const std::size_t first = c * arcs / chunks;
+                const std::size_t last = (c + 1) * arcs / chunks;
+                results.push_back(pool.submit([&function, first, last]() {
+                    function(first, last);
+                }));
+            }
+            for (auto& result : results)
+            {
+                result.get();
+            }
+        }
+
+    public:
+
+        /* Methods */
+
+        void run(osmium::memory::Buffer& buffer)
+        {
+            // If the tolerance is less or equal to zero and no budget is
+            // set, no compression will be applied.
+            if (m_tolerance <= 0 && m_max_points == 0 && m_max_bytes == 0)
+            {
+                return;
+            }
+
+            const model::Topology& topology = m_topology;
+
+            // Simplify each arc of the topology exactly once using the
+            // selected algorithm. The arcs start and end at junctions
+            // and do not share inner nodes, so shared borders are simplified
+            // identically for all boundaries and no holes are created between
+            // them. If a budget is set, the importance of each point is
+            // calculated once and the tolerance is selected from it.
+            osmium::thread::Pool pool{ m_threads };
+            std::vector<std::vector<bool>> kept = m_max_points > 0 || m_max_bytes > 0
+                ? select_by_budget(buffer, pool)
+                : simplify_arcs(pool);
+
+            // Restore removed points that are needed to avoid crossings. The
+            // restored points are not part of the budget selection, so the
+            // budget may be exceeded afterwards.
+            if (m_preserve_topology)
+            {
+                restore_crossings(kept);
+                if (m_max_points > 0 || m_max_bytes > 0)
+                {
+                    auto [points, bytes] = budget_costs(buffer, kept);
+                    if ((m_max_points > 0 && points > m_max_points) || (m_max_bytes > 0 && bytes > m_max_bytes))
+                    {
+                        std::cerr << "[Warning] Preserving the topology exceeded the compression budget with "
+                                  << points << " nodes and " << bytes << " bytes.\n";
+                    }
+                }
+            }
+
+            std::vector<bool> removed_nodes(topology.nodes.size(), false);
+            for (std::size_t a = 0; a < topology.arcs.size(); a++)
+            {
+                for (std::size_t i = 0; i < kept[a].size(); i++)
+                {
+                    if (!kept[a][i])
+                    {
+                        removed_nodes[topology.arcs[a][i]] = true;
+                    }
+                }
+            }
+            auto is_removed = [&](osmium::object_id_type id) {
+                const std::size_t i = topology.nodes.index(id);
+                return i != model::NodeIndex::npos && removed_nodes[i];
+            };
+
+            // Remove the nodes that were marked as removed by the arc
+            // simplification from the buffer in place, and rebuild the ways
+            // that referenced them.
+            Purger purger{ buffer };
+            for (osmium::OSMObject& object : buffer.select<osmium::OSMObject>())
+            {
+                switch (object.type())
+                {
+                case osmium::item_type::node:
+                    if (is_removed(object.id()))
+                    {
+                        purger.remove(object);
                     }
-                    result.commit();
+                    break;
+                case osmium::item_type::way:
+                    purger.remove_nodes(static_cast<osmium::Way&>(object), [&](const osmium::NodeRef& nr) {
+                        return is_removed(nr.ref());
+                    });
                     break;
                 default:
-                    result.add_item(object);
-                    result.commit();
+                    break;
                 }
             }
-
-            // Swap the old buffer with the resulting compressed buffer
-            std::swap(buffer, result);
+            purger.run();
         }
 
     };
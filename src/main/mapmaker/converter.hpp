@@ -36,6 +36,7 @@ namespace mapmaker
 		BoundaryConverter() {}
         BoundaryConverter(Transformation transformation) : m_transformations({ transformation }) {}
         BoundaryConverter(std::initializer_list<Transformation> transformations) : m_transformations(transformations) {}
+        BoundaryConverter(const std::vector<Transformation>& transformations) : m_transformations(transformations) {}
 
         /* Methods */
 
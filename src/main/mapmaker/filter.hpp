@@ -1,15 +1,19 @@
 #pragma once
 
+#include <algorithm>
 #include <numeric>
 
 #include <osmium/osm/node.hpp>
 #include <osmium/osm/area.hpp>
 
+#include "model/boundary_registry.hpp"
 #include "model/graph/undirected_graph.hpp"
 
 #include "handler/calculation_handler.hpp"
 #include "handler/filter_handler.hpp"
 
+#include "mapmaker/purger.hpp"
+
 using namespace model;
 
 namespace mapmaker
@@ -38,19 +42,28 @@ namespace mapmaker
          * Apply the filter on the specified area buffer.
          * Areas that have a smaller surface area relative to the
          * total surface area than the specified threshold will be
-         * removed.
+         * removed. The nodes and ways of the removed areas are also
+         * removed from the raw buffer, such that later assembly steps
+         * skip them.
          *
+         * @param buffer     The raw buffer with the nodes, ways and relations
+         * @param areas      The buffer with the assembled areas
+         * @param registry   The boundary registry of the areas
+         * @param neighbors  The neighbor graph of the areas
+         * @param components The connected components of the neighbor graph
          *
          * Time complexity: Linear
          */
         void run(
             osmium::memory::Buffer& buffer,
+            osmium::memory::Buffer& areas,
+            const model::BoundaryRegistry& registry,
             graph::UndirectedGraph& neighbors,
             std::vector<std::set<osmium::object_id_type>>& components
         ){
             // Calculate the surface areas of each area in the buffer.
             handler::SurfaceAreaHandler surface_handler{};
-            osmium::apply(buffer, surface_handler);
+            osmium::apply(areas, surface_handler);
             std::map<osmium::object_id_type, double> area_surfaces = surface_handler.surfaces();
             double total_surface = surface_handler.total();
 
@@ -90,80 +103,82 @@ namespace mapmaker
             
             // Retrieve the node references for the removed areas
             handler::AreaNodeFilterHandler node_handler{ removed_areas };
-            osmium::apply(buffer, node_handler);
+            osmium::apply(areas, node_handler);
             std::set<osmium::object_id_type> removed_nodes = node_handler.references();
 
-            // Retrieve the way references for the removed areas
-            handler::NodeWayFilterHandler way_handler{ removed_nodes };
-            osmium::apply(buffer, way_handler);
-            std::set<osmium::object_id_type> removed_ways = way_handler.references();
+            // Remove the marked areas from the area buffer in place
+            Purger area_purger{ areas };
+            for (osmium::Area& area : areas.select<osmium::Area>())
+            {
+                if (removed_areas.count(area.id()))
+                {
+                    area_purger.remove(area);
+                }
+            }
+            area_purger.run();
 
-            // Remove the marked areas and their associated nodes and ways from
-            // the buffer
-            osmium::memory::Buffer result{ 1024, osmium::memory::Buffer::auto_grow::yes };
-            for (const auto& object : buffer.select<osmium::OSMObject>())
+            // Remove the associated nodes, ways and relations from the raw
+            // buffer, unless it was already released because no assembly
+            // step follows
+            if (buffer)
             {
-                switch (object.type())
+                // Retrieve the way references for the removed areas
+                handler::NodeWayFilterHandler way_handler{ removed_nodes };
+                osmium::apply(buffer, way_handler);
+                std::set<osmium::object_id_type> removed_ways = way_handler.references();
+
+                // Map the removed boundaries back to the OSM areas, from which
+                // the ways and relations of the raw buffer are identified
+                std::set<osmium::object_id_type> removed_area_ids;
+                for (const osmium::object_id_type& id : removed_areas)
                 {
-                case osmium::item_type::node:
-                    if (!removed_nodes.count(object.id()))
-                    {
-                        result.add_item(object);
-                        result.commit();
-                    }
-                    break;
-                case osmium::item_type::way:
-                    if (!removed_ways.count(object.id()))
+                    removed_area_ids.insert(registry.area_id(id));
+                }
+
+                // Remove the associated nodes, ways and relations in place
+                Purger purger{ buffer };
+                for (osmium::OSMObject& object : buffer.select<osmium::OSMObject>())
+                {
+                    switch (object.type())
                     {
-                        if (!removed_areas.count(osmium::object_id_to_area_id(object.id(), object.type())))
+                    case osmium::item_type::node:
+                        if (removed_nodes.count(object.id()))
                         {
-                            result.add_item(object);
-                            result.commit();
+                            purger.remove(object);
                         }
-                    }
-                    break;
-                case osmium::item_type::relation:
-                    if (!removed_areas.count(osmium::object_id_to_area_id(object.id(), object.type())))
-                    {
+                        break;
+                    case osmium::item_type::way:
+                        if (removed_ways.count(object.id())
+                            || removed_area_ids.count(osmium::object_id_to_area_id(object.id(), object.type())))
                         {
-                            // Rebuild relation without the removed way members
-                            osmium::builder::RelationBuilder relation_builder{ result };
-
-                            // Copy the way attributes and tags
-                            relation_builder.set_id(object.id())
-                                .set_version(object.version())
-                                .set_changeset(object.changeset())
-                                .set_timestamp(object.timestamp())
-                                .set_uid(object.uid())
-                                .set_user(object.user())
-                                .add_item(object.tags());
-
+                            purger.remove(object);
+                        }
+                        break;
+                    case osmium::item_type::relation:
+                        if (removed_area_ids.count(osmium::object_id_to_area_id(object.id(), object.type())))
+                        {
+                            purger.remove(object);
+                        }
+                        else
+                        {
+                            // Rebuild the relation without the removed way members
+                            // if it references any of them
+                            auto is_removed = [&](const osmium::RelationMember& member) {
+                                return member.type() == osmium::item_type::way && removed_ways.count(member.ref());
+                            };
+                            const osmium::RelationMemberList& members = static_cast<const osmium::Relation&>(object).members();
+                            if (std::any_of(members.begin(), members.end(), is_removed))
                             {
-                                // Copy the relation references and filter the removed ways
-                                const osmium::Relation& relation = static_cast<const osmium::Relation&>(object);
-                                osmium::builder::RelationMemberListBuilder members_builder{ relation_builder };
-                                for (const osmium::RelationMember& member : relation.members())
-                                {
-                                    if (member.type() != osmium::item_type::way || !removed_ways.count(member.ref()))
-                                    {
-                                        members_builder.add_member(member.type(), member.ref(), member.role());
-                                    }
-                                }
+                                purger.remove_members(static_cast<osmium::Relation&>(object), is_removed);
                             }
                         }
-                        result.commit();
-                    }
-                    break;
-                case osmium::item_type::area:
-                    if (!removed_areas.count(object.id()))
-                    {
-                        result.add_item(object);
-                        result.commit();
+                        break;
+                    default:
+                        break;
                     }
-                    break;
                 }
+                purger.run();
             }
-            std::swap(buffer, result);
 
             // Remove the marked areas and their neighbors from the neighbor
             // graph by creating a filtered copy.
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cerrno>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+#include <osmium/index/map/dense_file_array.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#ifdef __linux__
+#include <osmium/index/map/sparse_mmap_array.hpp>
+#endif
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/node.hpp>
+
+#include "model/types.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace mapmaker
+{
+
+    /**
+     * Builds the node location index for a buffer once, such that it can be
+     * shared by the later stages of the pipeline.
+     *
+     * The following index backends are available:
+     * flex:        An in-memory index that switches between a sparse and a
+     *              dense storage depending on the node ids.
+     * sparse_mmap: A sparse index in anonymous memory mapped storage, which
+     *              is only available on Linux.
+     * dense_file:  A dense index in a file backed memory mapping, which is
+     *              suited for planet sized node id ranges.
+     */
+    class Indexer
+    {
+    protected:
+
+        /* Members */
+
+        /**
+         * The index backend.
+         */
+        std::string m_type;
+
+        /**
+         * The directory for file backed indices.
+         */
+        fs::path m_dir;
+
+        /**
+         * The file of a file backed index. Removed on destruction.
+         */
+        fs::path m_file;
+
+        /**
+         * The descriptor of the file of a file backed index. Closed on
+         * destruction.
+         */
+        int m_fd = -1;
+
+    public:
+
+        /* Constructors */
+
+        Indexer(std::string type, fs::path dir = fs::temp_directory_path()) : m_type(type), m_dir(dir) {}
+
+        Indexer(const Indexer&) = delete;
+        Indexer& operator=(const Indexer&) = delete;
+
+        ~Indexer()
+        {
+            if (m_fd >= 0)
+            {
+                ::close(m_fd);
+            }
+            if (!m_file.empty())
+            {
+                boost::system::error_code error;
+                fs::remove(m_file, error);
+            }
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        /**
+         * Create an empty index of the selected type. The index types are
+         * constructed directly instead of through the osmium map factory,
+         * whose configuration strings cannot contain arbitrary file paths.
+         *
+         * @returns The index
+         * @throws  std::invalid_argument if the index type is unknown or not
+         *          available on this platform
+         * @throws  std::system_error if the index file cannot be created
+         */
+        std::unique_ptr<model::location_index_type> create()
+        {
+            using id_type = osmium::unsigned_object_id_type;
+            if (m_type == "flex")
+            {
+                return std::make_unique<osmium::index::map::FlexMem<id_type, osmium::Location>>();
+            }
+#ifdef __linux__
+            if (m_type == "sparse_mmap")
+            {
+                return std::make_unique<osmium::index::map::SparseMmapArray<id_type, osmium::Location>>();
+            }
+#endif
+            if (m_type == "dense_file")
+            {
+                m_file = m_dir / fs::unique_path("locations-%%%%-%%%%-%%%%.idx");
+                m_fd = ::open(m_file.string().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+                if (m_fd < 0)
+                {
+                    throw std::system_error{ errno, std::system_category(), "Could not create the index file " + m_file.string() };
+                }
+                return std::make_unique<osmium::index::map::DenseFileArray<id_type, osmium::Location>>(m_fd);
+            }
+            throw std::invalid_argument("Unsupported location index type '" + m_type + "'");
+        }
+
+    public:
+
+        /* Methods */
+
+        /**
+         * Build the location index for the nodes of a buffer.
+         *
+         * @param buffer The buffer
+         * @returns      The location index
+         *
+         * Time complexity: Linear (Log-Linear for sparse indices)
+         */
+        std::unique_ptr<model::location_index_type> run(const osmium::memory::Buffer& buffer)
+        {
+            std::unique_ptr<model::location_index_type> index = create();
+            for (const osmium::Node& node : buffer.select<osmium::Node>())
+            {
+                index->set(node.positive_id(), node.location());
+            }
+            index->sort();
+            return index;
+        }
+
+    };
+
+}
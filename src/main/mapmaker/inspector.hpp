@@ -1,11 +1,21 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
+
+#include <osmium/osm/area.hpp>
+#include <osmium/thread/pool.hpp>
 
 #include "model/graph/undirected_graph.hpp"
 
 #include "functions/intersect.hpp"
+#include "functions/sort.hpp"
 
 #include "util/insert.hpp"
 
@@ -18,16 +28,66 @@ namespace mapmaker
     class NeighborInspector
     {
 
+        /* Types */
+
+        using reference_type = std::pair<osmium::object_id_type, osmium::object_id_type>;
+
         /* Members */
 
         model::level_type m_level;
 
+        /**
+         * The number of worker threads. If set to 0, the number of threads
+         * is determined automatically.
+         */
+        int m_threads = 0;
+
     public:
 
         /* Constructors */
 
         NeighborInspector(model::level_type level) : m_level(level) {};
 
+        /* Setters */
+
+        void threads(int threads)
+        {
+            m_threads = threads;
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        /**
+         * Retrieve the radix sort key of an id. Negative ids are mapped above
+         * the positive ids, which keeps equal ids together.
+         *
+         * @param id The id
+         * @returns  The unsigned key
+         */
+        static std::uint64_t key(osmium::object_id_type id)
+        {
+            return static_cast<std::uint64_t>(id);
+        }
+
+        /**
+         * Append the node references of a ring with the area id.
+         *
+         * @param references The node and area id pairs
+         * @param ring       The ring
+         * @param area       The area id
+         */
+        static void add_ring(std::vector<reference_type>& references, const osmium::NodeRefList& ring, osmium::object_id_type area)
+        {
+            for (const osmium::NodeRef& nr : ring)
+            {
+                references.emplace_back(nr.ref(), area);
+            }
+        }
+
+    public:
+
         /* Methods */
 
         /**
@@ -35,6 +95,12 @@ namespace mapmaker
          * which areas contain the same node references. If they do so, they are
          * considered to be neighbors. As the neighbor relation is symmetric,
          * the graph is chosen as undirected.
+         *
+         * The node references of all areas are collected as flat pairs of
+         * node and area id and sorted by node with a parallel radix sort.
+         * Each run of equal nodes yields the edges between its areas, which
+         * are sorted and deduplicated the same way before they are inserted
+         * into the graph.
          * 
          * @returns The neighbor graph, where vertices represent the areas and
          *          edges represent a neighborship between to areas
@@ -44,41 +110,77 @@ namespace mapmaker
         model::graph::UndirectedGraph run(const osmium::memory::Buffer& buffer)
         {
             graph::UndirectedGraph neighbors;
-            
-            std::map<osmium::object_id_type, std::set<osmium::object_id_type>> references{};
+            osmium::thread::Pool pool{ m_threads };
+
+            std::vector<reference_type> references;
             for (const osmium::Area& area : buffer.select<osmium::Area>())
             {
+                // Skip areas of other levels, which are assembled in the
+                // same buffer
+                if (std::atoi(area.get_value_by_key("admin_level", "0")) != m_level)
+                {
+                    continue;
+                }
+
                 // Create a vertex for the area in the neighbor graph
                 neighbors.insert_vertex(area.id());
 
                 // Collect the node references for this area
                 for (const osmium::OuterRing& outer : area.outer_rings())
                 {
-                    for (const osmium::NodeRef& nr : outer)
-                    {
-                        util::insert(references, nr.ref(), area.id());
-                    }
+                    add_ring(references, outer, area.id());
                     for (const osmium::InnerRing& inner : area.inner_rings(outer))
                     {
-                        for (const osmium::NodeRef& nr : inner)
-                        {
-                            util::insert(references, nr.ref(), area.id());
-                        }
+                        add_ring(references, inner, area.id());
                     }
                 }
             }
 
-            // Create edges in the graph for each two areas that share a common
-            // node.
-            for (const auto& [node, areas] : references)
+            // Group the references by node. Only equal nodes have to be
+            // adjacent, so the order of the keys is irrelevant. The sort is
+            // stable, so the references of an area stay contiguous within
+            // each group.
+            functions::radix_sort(references, [](const reference_type& r) { return key(r.first); }, pool);
+
+            // Create an edge for each two areas that share a common node.
+            std::vector<reference_type> edges;
+            std::vector<osmium::object_id_type> areas;
+            for (std::size_t first = 0; first < references.size();)
             {
-                for (auto it1 = areas.begin(); it1 != areas.end(); it1++)
+                std::size_t last = first + 1;
+                while (last < references.size() && references[last].first == references[first].first)
                 {
-                    for (auto it2 = std::next(it1, 1); it2 != areas.end(); it2++)
+                    ++last;
+                }
+
+                // Skip the repeated references of the same area, like the
+                // closing node of a ring
+                areas.clear();
+                for (std::size_t i = first; i < last; i++)
+                {
+                    if (areas.empty() || areas.back() != references[i].second)
                     {
-                        neighbors.insert_edge(std::make_pair(*it1, *it2));
+                        areas.push_back(references[i].second);
                     }
                 }
+                for (std::size_t i = 0; i < areas.size(); i++)
+                {
+                    for (std::size_t j = i + 1; j < areas.size(); j++)
+                    {
+                        edges.push_back(std::minmax(areas[i], areas[j]));
+                    }
+                }
+                first = last;
+            }
+
+            // Sort the edges lexicographically with two stable passes and
+            // insert each distinct edge once.
+            functions::radix_sort(edges, [](const reference_type& e) { return key(e.second); }, pool);
+            functions::radix_sort(edges, [](const reference_type& e) { return key(e.first); }, pool);
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+            for (const reference_type& edge : edges)
+            {
+                neighbors.insert_edge(edge);
             }
 
             return neighbors;
@@ -116,16 +218,19 @@ namespace mapmaker
                 return {};
             }
 
-            // Prepare the component map that stores the component for each
-            // vertex in the neighbor graph.
-            std::map<osmium::object_id_type, std::size_t> components;
+            // Prepare the component table that stores the component for each
+            // vertex in the neighbor graph. The vertices are dense boundary
+            // ids, so the table is indexed by the vertex directly.
+            const std::size_t npos = std::numeric_limits<std::size_t>::max();
+            const std::size_t size = static_cast<std::size_t>(*neighbors.vertices().rbegin()) + 1;
+            std::vector<std::size_t> components(size, npos);
 
             // Calculate the connected components.
             std::size_t c = 0;
             for (const graph::vertex_type& vertex : neighbors.vertices())
             {
                 // Check if the current vertex was visited already
-                if (!components.count(vertex))
+                if (components[vertex] == npos)
                 {
                     // Perform depth-first-search with the current vertex as
                     // starting point
@@ -141,7 +246,7 @@ namespace mapmaker
                         components[v] = c;
                         for (const auto& adjacent : neighbors.adjacents(v))
                         {
-                            if (!components.count(adjacent))
+                            if (components[adjacent] == npos)
                             {
                                 stack.push(adjacent);
                             }
@@ -157,9 +262,9 @@ namespace mapmaker
             // Reverse the component map, such that the component becomes the
             // index and the areas become the values.
             std::vector<std::set<osmium::object_id_type>> result(c, std::set<osmium::object_id_type>{});
-            for (const auto& [area, component] : components)
+            for (const graph::vertex_type& vertex : neighbors.vertices())
             {
-                result.at(component).insert(area);
+                result.at(components[vertex]).insert(vertex);
             }
 
             return result;
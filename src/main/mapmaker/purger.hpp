@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/memory/item.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+
+namespace mapmaker
+{
+
+    /**
+     * Removes objects, way node references and relation members from a
+     * buffer in place, instead of copying all remaining objects into a new
+     * buffer.
+     *
+     * Objects are marked as removed and dropped from the buffer by run().
+     * As the size of an osmium item cannot shrink in place, ways with removed
+     * node references and relations with removed members are rebuilt into a
+     * pending buffer and appended to the buffer by run(). Objects that are
+     * not affected stay in place, and the rebuilt objects have their exact
+     * size, so consumers never see stale node references or members.
+     */
+    class Purger
+    {
+    protected:
+
+        /* Members */
+
+        osmium::memory::Buffer& m_buffer;
+
+        /**
+         * The rebuilt relations that replace relations with removed members.
+         */
+        osmium::memory::Buffer m_pending{ 1024, osmium::memory::Buffer::auto_grow::yes };
+
+    public:
+
+        /* Constructors */
+
+        Purger(osmium::memory::Buffer& buffer) : m_buffer(buffer) {}
+
+        /* Methods */
+
+        /**
+         * Mark an object for removal.
+         *
+         * @param item The object
+         */
+        void remove(osmium::memory::Item& item)
+        {
+            item.set_removed(true);
+        }
+
+        /**
+         * Remove node references from a way. If any node reference is
+         * removed, the way is rebuilt without it and replaces the original
+         * way in run().
+         *
+         * @param way     The way
+         * @param removed The predicate for removed node references
+         *
+         * Time complexity: Linear
+         */
+        template <typename TPredicate>
+        void remove_nodes(osmium::Way& way, TPredicate&& removed)
+        {
+            const osmium::WayNodeList& nodes = way.nodes();
+            if (std::none_of(nodes.begin(), nodes.end(), removed))
+            {
+                return;
+            }
+            {
+                osmium::builder::WayBuilder way_builder{ m_pending };
+
+                // Copy the way id and tags. The metadata is not used by the
+                // map pipeline and is skipped.
+                way_builder.set_id(way.id())
+                    .add_item(way.tags());
+
+                osmium::builder::WayNodeListBuilder nodes_builder{ way_builder };
+                for (const osmium::NodeRef& nr : nodes)
+                {
+                    if (!removed(nr))
+                    {
+                        nodes_builder.add_node_ref(nr);
+                    }
+                }
+            }
+            m_pending.commit();
+            way.set_removed(true);
+        }
+
+        /**
+         * Remove members from a relation. The relation is rebuilt without the
+         * members and replaces the original relation in run().
+         *
+         * @param relation The relation
+         * @param removed  The predicate for removed members
+         *
+         * Time complexity: Linear
+         */
+        template <typename TPredicate>
+        void remove_members(osmium::Relation& relation, TPredicate&& removed)
+        {
+            {
+                osmium::builder::RelationBuilder relation_builder{ m_pending };
+
+                // Copy the relation id and tags. The metadata is not used by
+                // the map pipeline and is skipped.
+                relation_builder.set_id(relation.id())
+                    .add_item(relation.tags());
+
+                osmium::builder::RelationMemberListBuilder members_builder{ relation_builder };
+                for (const osmium::RelationMember& member : relation.members())
+                {
+                    if (!removed(member))
+                    {
+                        members_builder.add_member(member.type(), member.ref(), member.role());
+                    }
+                }
+            }
+            m_pending.commit();
+            relation.set_removed(true);
+        }
+
+        /**
+         * Drop the removed objects from the buffer and append the rebuilt
+         * ways and relations.
+         *
+         * Time complexity: Linear
+         */
+        void run()
+        {
+            m_buffer.purge_removed();
+            if (m_pending.committed() > 0)
+            {
+                m_buffer.add_buffer(m_pending);
+                m_buffer.commit();
+                m_pending.clear();
+            }
+        }
+
+    };
+
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include "model/node_index.hpp"
+#include "model/topology.hpp"
+#include "model/types.hpp"
+
+namespace mapmaker
+{
+
+    /**
+     * Builds the shared-arc topology of the ways in a buffer.
+     *
+     * A node becomes a junction if it is the first or last node of a way, or
+     * if its neighbors differ between the ways that contain it. Between two
+     * junctions, all ways that share a node follow the same path, so the
+     * pieces of the ways between junctions can be deduplicated by their
+     * first two nodes.
+     */
+    class TopologyBuilder
+    {
+    protected:
+
+        /* Types */
+
+        using edge_type = std::pair<std::size_t, std::size_t>;
+
+        /* Members */
+
+        /**
+         * The node location index of the buffer.
+         */
+        const model::location_index_type& m_index;
+
+    public:
+
+        /* Constructors */
+
+        TopologyBuilder(const model::location_index_type& index) : m_index(index) {}
+
+    protected:
+
+        /* Helper Methods */
+
+        /**
+         * Mark the junction nodes of the topology.
+         *
+         * @param topology The topology with the node index
+         * @param ways     The dense node indices of the ways
+         *
+         * Time complexity: Linear
+         */
+        void mark_junctions(model::Topology& topology, const std::vector<std::vector<std::size_t>>& ways) const
+        {
+            const std::size_t npos = model::NodeIndex::npos;
+            topology.junctions.assign(topology.nodes.size(), false);
+            std::vector<edge_type> neighbors(topology.nodes.size(), { npos, npos });
+            for (const std::vector<std::size_t>& way : ways)
+            {
+                for (std::size_t i = 0; i < way.size(); i++)
+                {
+                    const std::size_t n = way[i];
+                    if (i == 0 || i + 1 == way.size())
+                    {
+                        topology.junctions[n] = true;
+                        continue;
+                    }
+
+                    // Compare the unordered neighbor pair with the pair of
+                    // the first occurrence of the node
+                    const edge_type pair = std::minmax(way[i - 1], way[i + 1]);
+                    if (neighbors[n].first == npos)
+                    {
+                        neighbors[n] = pair;
+                    }
+                    else if (neighbors[n] != pair)
+                    {
+                        topology.junctions[n] = true;
+                    }
+                }
+            }
+        }
+
+    public:
+
+        /* Methods */
+
+        /**
+         * Build the topology of the ways in the buffer.
+         *
+         * @param buffer The buffer
+         * @returns      The topology
+         *
+         * Time complexity: Log-Linear
+         */
+        model::Topology run(const osmium::memory::Buffer& buffer) const
+        {
+            model::Topology topology;
+
+            // Map the ids of all nodes referenced by ways to dense indices
+            for (const osmium::Way& way : buffer.select<osmium::Way>())
+            {
+                for (const osmium::NodeRef& nr : way.nodes())
+                {
+                    topology.nodes.add(nr.ref());
+                }
+            }
+            topology.nodes.build();
+
+            topology.locations.resize(topology.nodes.size());
+            for (std::size_t i = 0; i < topology.nodes.size(); i++)
+            {
+                topology.locations[i] = m_index.get_noexcept(
+                    static_cast<osmium::unsigned_object_id_type>(topology.nodes.id(i))
+                );
+            }
+
+            // Resolve the dense node indices of the ways once
+            std::vector<std::vector<std::size_t>> ways;
+            for (const osmium::Way& way : buffer.select<osmium::Way>())
+            {
+                std::vector<std::size_t> indices;
+                indices.reserve(way.nodes().size());
+                for (const osmium::NodeRef& nr : way.nodes())
+                {
+                    indices.push_back(topology.nodes.index(nr.ref()));
+                }
+                topology.ways.push_back(way.id());
+                ways.push_back(std::move(indices));
+            }
+
+            mark_junctions(topology, ways);
+
+            // Split the ways at the junctions into pieces. The pieces are
+            // looked up by their first edge in both directions, such that
+            // pieces that were already stored are referenced instead.
+            std::map<edge_type, model::ArcRef> arcs;
+            topology.way_arcs.resize(ways.size());
+            for (std::size_t w = 0; w < ways.size(); w++)
+            {
+                const std::vector<std::size_t>& way = ways[w];
+                std::size_t start = 0;
+                for (std::size_t i = 1; i < way.size(); i++)
+                {
+                    if (!topology.junctions[way[i]])
+                    {
+                        continue;
+                    }
+
+                    auto it = arcs.find({ way[start], way[start + 1] });
+                    if (it != arcs.end())
+                    {
+                        topology.way_arcs[w].push_back(it->second);
+                    }
+                    else
+                    {
+                        const std::size_t arc = topology.arcs.size();
+                        topology.arcs.emplace_back(way.begin() + start, way.begin() + i + 1);
+                        arcs.emplace(edge_type{ way[start], way[start + 1] }, model::ArcRef{ arc, false });
+                        arcs.emplace(edge_type{ way[i], way[i - 1] }, model::ArcRef{ arc, true });
+                        topology.way_arcs[w].push_back(model::ArcRef{ arc, false });
+                    }
+                    start = i;
+                }
+            }
+            return topology;
+        }
+
+    };
+
+}
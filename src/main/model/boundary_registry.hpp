@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "model/types.hpp"
+
+namespace model
+{
+
+    /**
+     * A registry that assigns dense boundary ids in the range [0, size()) to
+     * the assembled areas and keeps the reverse table to their OSM area ids.
+     *
+     * Splitting a multipolygon creates multiple boundaries from a single OSM
+     * area, so OSM area ids are not unique across boundaries. Dense ids are
+     * unique and allow boundary attributes to be kept in flat arrays or
+     * bitsets that are indexed by the boundary id.
+     *
+     * The assembler stores the dense id as the id of each area in the area
+     * buffer, so these ids are not osmium area ids. They do not follow the
+     * osmium encoding of the OSM object id (id * 2 for ways, id * 2 + 1 for
+     * relations), so osmium::Area::from_way() and osmium::Area::orig_id()
+     * return meaningless values for them, and the first boundary has the id
+     * 0, which osmium otherwise uses for objects without id. The OSM object
+     * is recovered through area_id() instead.
+     */
+    class BoundaryRegistry
+    {
+    protected:
+
+        /* Members */
+
+        /**
+         * The OSM area id of each boundary. The position of an OSM area id
+         * is the dense boundary id.
+         */
+        std::vector<object_id_type> m_ids;
+
+    public:
+
+        /* Accessors */
+
+        std::size_t size() const noexcept
+        {
+            return m_ids.size();
+        }
+
+        /**
+         * Retrieve the OSM area id of a boundary.
+         *
+         * @param id The dense boundary id
+         * @returns  The OSM area id
+         */
+        object_id_type area_id(object_id_type id) const
+        {
+            return m_ids.at(static_cast<std::size_t>(id));
+        }
+
+        /* Methods */
+
+        /**
+         * Register a new boundary for an OSM area.
+         *
+         * @param area_id The OSM area id
+         * @returns       The dense boundary id
+         *
+         * Time complexity: Constant (Amortized)
+         */
+        object_id_type add(object_id_type area_id)
+        {
+            m_ids.push_back(area_id);
+            return static_cast<object_id_type>(m_ids.size() - 1);
+        }
+
+    };
+
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <osmium/osm/location.hpp>
+
+#include "model/geometry/multipolygon.hpp"
+#include "model/geometry/point.hpp"
+#include "model/geometry/rectangle.hpp"
+#include "model/geometry/ring.hpp"
+
+namespace model
+{
+
+    /**
+     * A geographic clip window, which is either a bounding box or a
+     * multipolygon in degrees. The x coordinates are longitudes and the
+     * y coordinates are latitudes.
+     */
+    class ClipWindow
+    {
+        /* Members */
+
+        /**
+         * The bounding box of the window.
+         */
+        geometry::Rectangle<double> m_bounds;
+
+        /**
+         * The polygons of the window. If empty, the window is the bounding
+         * box.
+         */
+        geometry::MultiPolygon<double> m_polygons;
+
+        /**
+         * The reference points of the window, which are the center of the
+         * bounding box or the first outer point of each polygon.
+         */
+        std::vector<geometry::Point<double>> m_references;
+
+        /* Helper Methods */
+
+        /**
+         * Check if a point is inside of a ring with the crossing number
+         * algorithm.
+         *
+         * @param x    The x coordinate of the point
+         * @param y    The y coordinate of the point
+         * @param ring The ring
+         * @returns    True if the point is inside of the ring
+         *
+         * Time complexity: Linear
+         */
+        static bool in_ring(double x, double y, const geometry::Ring<double>& ring)
+        {
+            bool inside = false;
+            for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+            {
+                const geometry::Point<double>& a = ring.at(i);
+                const geometry::Point<double>& b = ring.at(j);
+                if ((a.y() > y) != (b.y() > y)
+                    && x < (b.x() - a.x()) * (y - a.y()) / (b.y() - a.y()) + a.x())
+                {
+                    inside = !inside;
+                }
+            }
+            return inside;
+        }
+
+        /**
+         * Calculate the orientation of the point c relative to the line
+         * through the points a and b.
+         *
+         * @returns A positive value for counterclockwise, a negative value
+         *          for clockwise and 0 for collinear points
+         */
+        static double orientation(double ax, double ay, double bx, double by, double cx, double cy)
+        {
+            return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        }
+
+        /**
+         * Check if two segments intersect, including touching segments.
+         *
+         * Time complexity: Constant
+         */
+        static bool segments_intersect(
+            double ax, double ay, double bx, double by,
+            double cx, double cy, double dx, double dy
+        ) {
+            const double o1 = orientation(ax, ay, bx, by, cx, cy);
+            const double o2 = orientation(ax, ay, bx, by, dx, dy);
+            const double o3 = orientation(cx, cy, dx, dy, ax, ay);
+            const double o4 = orientation(cx, cy, dx, dy, bx, by);
+            if (((o1 > 0 && o2 < 0) || (o1 < 0 && o2 > 0)) && ((o3 > 0 && o4 < 0) || (o3 < 0 && o4 > 0)))
+            {
+                return true;
+            }
+            // Collinear and touching cases
+            auto on_segment = [](double px, double py, double qx, double qy, double rx, double ry) {
+                return std::min(px, qx) <= rx && rx <= std::max(px, qx)
+                    && std::min(py, qy) <= ry && ry <= std::max(py, qy);
+            };
+            return (o1 == 0 && on_segment(ax, ay, bx, by, cx, cy))
+                || (o2 == 0 && on_segment(ax, ay, bx, by, dx, dy))
+                || (o3 == 0 && on_segment(cx, cy, dx, dy, ax, ay))
+                || (o4 == 0 && on_segment(cx, cy, dx, dy, bx, by));
+        }
+
+        /**
+         * Check if a segment intersects an edge of a ring.
+         *
+         * Time complexity: Linear
+         */
+        static bool crosses_ring(double ax, double ay, double bx, double by, const geometry::Ring<double>& ring)
+        {
+            for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++)
+            {
+                if (segments_intersect(ax, ay, bx, by, ring.at(j).x(), ring.at(j).y(), ring.at(i).x(), ring.at(i).y()))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    public:
+
+        /* Constructors */
+
+        ClipWindow(const geometry::Rectangle<double>& bounds) : m_bounds(bounds)
+        {
+            m_references.push_back(geometry::Point<double>{
+                (m_bounds.min().x() + m_bounds.max().x()) / 2,
+                (m_bounds.min().y() + m_bounds.max().y()) / 2
+            });
+        }
+
+        ClipWindow(const geometry::MultiPolygon<double>& polygons) : m_polygons(polygons)
+        {
+            // Calculate the bounding box of the outer rings
+            m_bounds = geometry::Rectangle<double>{ 180.0, 90.0, -180.0, -90.0 };
+            for (const auto& polygon : m_polygons.polygons())
+            {
+                for (const auto& point : polygon.outer())
+                {
+                    m_bounds.min().x() = std::min(m_bounds.min().x(), point.x());
+                    m_bounds.min().y() = std::min(m_bounds.min().y(), point.y());
+                    m_bounds.max().x() = std::max(m_bounds.max().x(), point.x());
+                    m_bounds.max().y() = std::max(m_bounds.max().y(), point.y());
+                }
+                if (!polygon.outer().empty())
+                {
+                    m_references.push_back(polygon.outer().at(0));
+                }
+            }
+        }
+
+        /* Accessors */
+
+        const geometry::Rectangle<double>& bounds() const
+        {
+            return m_bounds;
+        }
+
+        const geometry::MultiPolygon<double>& polygons() const
+        {
+            return m_polygons;
+        }
+
+        /**
+         * Retrieve the reference points of this window. If no segment of a
+         * ring intersects the window, a polygon of the window lies inside
+         * of the ring exactly if its reference point does.
+         */
+        const std::vector<geometry::Point<double>>& references() const
+        {
+            return m_references;
+        }
+
+        /* Methods */
+
+        /**
+         * Check if a location lies inside of this window.
+         *
+         * @param location The location
+         * @returns        True if the location is valid and inside
+         *
+         * Time complexity: Constant for bounding boxes, linear in the
+         * number of polygon points otherwise
+         */
+        bool contains(const osmium::Location& location) const
+        {
+            if (!location.valid())
+            {
+                return false;
+            }
+            const double x = location.lon();
+            const double y = location.lat();
+            if (x < m_bounds.min().x() || x > m_bounds.max().x()
+                || y < m_bounds.min().y() || y > m_bounds.max().y())
+            {
+                return false;
+            }
+            if (m_polygons.polygons().empty())
+            {
+                return true;
+            }
+            return std::any_of(m_polygons.polygons().begin(), m_polygons.polygons().end(),
+                [&](const geometry::Polygon<double>& polygon) {
+                    return in_ring(x, y, polygon.outer())
+                        && std::none_of(polygon.inners().begin(), polygon.inners().end(),
+                            [&](const geometry::Ring<double>& inner) { return in_ring(x, y, inner); }
+                        );
+                }
+            );
+        }
+
+        /**
+         * Check if a segment intersects this window, either with an end
+         * point inside of the window or by crossing its border.
+         *
+         * @param a The first segment location
+         * @param b The second segment location
+         * @returns True if both locations are valid and the segment
+         *          intersects the window
+         *
+         * Time complexity: Constant for bounding boxes, linear in the
+         * number of polygon points otherwise
+         */
+        bool intersects(const osmium::Location& a, const osmium::Location& b) const
+        {
+            if (!a.valid() || !b.valid())
+            {
+                return false;
+            }
+            const double ax = a.lon();
+            const double ay = a.lat();
+            const double bx = b.lon();
+            const double by = b.lat();
+            if (std::max(ax, bx) < m_bounds.min().x() || std::min(ax, bx) > m_bounds.max().x()
+                || std::max(ay, by) < m_bounds.min().y() || std::min(ay, by) > m_bounds.max().y())
+            {
+                return false;
+            }
+            if (contains(a) || contains(b))
+            {
+                return true;
+            }
+            if (m_polygons.polygons().empty())
+            {
+                geometry::Ring<double> box;
+                box.push_back({ m_bounds.min().x(), m_bounds.min().y() });
+                box.push_back({ m_bounds.max().x(), m_bounds.min().y() });
+                box.push_back({ m_bounds.max().x(), m_bounds.max().y() });
+                box.push_back({ m_bounds.min().x(), m_bounds.max().y() });
+                return crosses_ring(ax, ay, bx, by, box);
+            }
+            for (const auto& polygon : m_polygons.polygons())
+            {
+                if (crosses_ring(ax, ay, bx, by, polygon.outer()))
+                {
+                    return true;
+                }
+                for (const auto& inner : polygon.inners())
+                {
+                    if (crosses_ring(ax, ay, bx, by, inner))
+                    {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Check if a segment crosses the horizontal ray from a reference
+         * point in positive x direction. The parity of the crossings over
+         * all segments of closed rings determines if the reference point
+         * lies inside of the rings.
+         *
+         * @param a         The first segment location
+         * @param b         The second segment location
+         * @param reference The index of the reference point
+         * @returns True if both locations are valid and the segment crosses
+         *          the ray
+         *
+         * Time complexity: Constant
+         */
+        bool crosses_reference_ray(const osmium::Location& a, const osmium::Location& b, std::size_t reference) const
+        {
+            if (!a.valid() || !b.valid())
+            {
+                return false;
+            }
+            const geometry::Point<double>& p = m_references.at(reference);
+            const double ax = a.lon();
+            const double ay = a.lat();
+            const double bx = b.lon();
+            const double by = b.lat();
+            return (ay > p.y()) != (by > p.y())
+                && p.x() < (bx - ax) * (p.y() - ay) / (by - ay) + ax;
+        }
+
+    };
+
+}
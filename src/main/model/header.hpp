@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <optional>
 
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/file_compression.hpp>
@@ -12,6 +13,23 @@
 namespace model
 {
 
+    /**
+     * The sampling information of an estimated header. The margins are the
+     * half widths of the 95% confidence intervals of the estimated counts.
+     */
+    struct Estimate
+    {
+        // Sample information
+        std::size_t blocks;
+        std::size_t samples;
+        // Confidence margins
+        std::size_t nodes;
+        std::size_t ways;
+        std::size_t relations;
+        std::size_t boundaries;
+        std::map<level_type, std::size_t> levels;
+    };
+
     /**
      * A container for OSM file headers and other generic data.
      */
@@ -22,15 +40,19 @@ namespace model
         osmium::io::file_format format;
         osmium::io::file_compression compression;
         std::size_t size;
-        // Osmium object information
-        std::size_t nodes;
-        std::size_t ways;
+        // Osmium object information. The node and way counts are empty if
+        // the objects were not counted.
+        std::optional<std::size_t> nodes;
+        std::optional<std::size_t> ways;
         std::size_t relations;
-        // Bounding Box information
+        // Bounding Box information. The bounds are invalid if they were
+        // not determined.
         osmium::Box bounds;
         // Boundary information
         std::size_t boundaries;
         std::map<level_type, std::size_t> levels;
+        // Sampling information. Empty if the header was not estimated.
+        std::optional<Estimate> estimate = std::nullopt;
     };
 
 }
\ No newline at end of file
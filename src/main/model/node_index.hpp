@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "model/types.hpp"
+
+namespace model
+{
+
+    /**
+     * A compact mapping from OSM node ids to dense indices in the range
+     * [0, size()). The ids are stored in a sorted flat array, so node
+     * attributes can be kept in flat arrays or bitsets that are indexed by
+     * the dense index instead of node based maps and sets.
+     *
+     * The ids are collected with add() first. Afterwards, the mapping is
+     * built once with build() and can be queried with index().
+     */
+    class NodeIndex
+    {
+    public:
+
+        /* Constants */
+
+        /**
+         * The index returned for ids that are not contained in the mapping.
+         */
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    protected:
+
+        /* Members */
+
+        /**
+         * The sorted and unique node ids. The position of an id is its
+         * dense index.
+         */
+        std::vector<object_id_type> m_ids;
+
+    public:
+
+        /* Accessors */
+
+        std::size_t size() const noexcept
+        {
+            return m_ids.size();
+        }
+
+        object_id_type id(std::size_t index) const
+        {
+            return m_ids.at(index);
+        }
+
+        /* Methods */
+
+        void reserve(std::size_t size)
+        {
+            m_ids.reserve(size);
+        }
+
+        /**
+         * Add a node id to the mapping. Duplicates are removed by build().
+         *
+         * @param id The node id
+         */
+        void add(object_id_type id)
+        {
+            m_ids.push_back(id);
+        }
+
+        /**
+         * Build the mapping from the added node ids.
+         *
+         * Time complexity: Log-Linear
+         */
+        void build()
+        {
+            std::sort(m_ids.begin(), m_ids.end());
+            m_ids.erase(std::unique(m_ids.begin(), m_ids.end()), m_ids.end());
+            m_ids.shrink_to_fit();
+        }
+
+        /**
+         * Retrieve the dense index of a node id.
+         *
+         * @param id The node id
+         * @returns  The dense index or npos if the id is not contained
+         *
+         * Time complexity: Logarithmic
+         */
+        std::size_t index(object_id_type id) const noexcept
+        {
+            auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+            if (it == m_ids.end() || *it != id)
+            {
+                return npos;
+            }
+            return static_cast<std::size_t>(it - m_ids.begin());
+        }
+
+    };
+
+}
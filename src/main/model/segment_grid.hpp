@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "model/geometry/point.hpp"
+#include "model/geometry/rectangle.hpp"
+
+namespace model
+{
+
+    /**
+     * A uniform grid over a bounding box that indexes segments by the cells
+     * their bounding box overlaps. Queries return the segments in the cells
+     * of a query segment, so only nearby segments have to be tested for
+     * intersections.
+     *
+     * The grid has about as many cells as segments, so each cell holds a
+     * constant number of segments for evenly distributed segments. Queries
+     * report each segment once, even if it overlaps multiple cells, so long
+     * segments do not multiply the number of candidates.
+     */
+    template <typename T>
+    class SegmentGrid
+    {
+    protected:
+
+        /* Members */
+
+        geometry::Rectangle<T> m_bounds;
+
+        std::size_t m_columns;
+
+        std::size_t m_rows;
+
+        /**
+         * The segment ids of each cell in row-major order.
+         */
+        std::vector<std::vector<std::size_t>> m_cells;
+
+        /**
+         * The number of the last query that reported each segment id, which
+         * deduplicates the segments of a query.
+         */
+        std::vector<std::size_t> m_stamps;
+
+        /**
+         * The number of the current query.
+         */
+        std::size_t m_query = 0;
+
+    public:
+
+        /* Constructors */
+
+        /**
+         * Create an empty grid.
+         *
+         * @param bounds   The bounding box of all segments
+         * @param segments The expected number of segments
+         */
+        SegmentGrid(const geometry::Rectangle<T>& bounds, std::size_t segments) : m_bounds(bounds)
+        {
+            const std::size_t side = std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(double(segments))));
+            m_columns = side;
+            m_rows = side;
+            m_cells.resize(m_columns * m_rows);
+            m_stamps.resize(segments, 0);
+        }
+
+    protected:
+
+        /* Helper Methods */
+
+        std::size_t column(T x) const
+        {
+            const double width = m_bounds.width();
+            if (width <= 0)
+            {
+                return 0;
+            }
+            const double c = (x - m_bounds.min().x()) / width * m_columns;
+            return std::min(m_columns - 1, static_cast<std::size_t>(std::max(0.0, c)));
+        }
+
+        std::size_t row(T y) const
+        {
+            const double height = m_bounds.height();
+            if (height <= 0)
+            {
+                return 0;
+            }
+            const double r = (y - m_bounds.min().y()) / height * m_rows;
+            return std::min(m_rows - 1, static_cast<std::size_t>(std::max(0.0, r)));
+        }
+
+        /**
+         * Call a function for each cell that the bounding box of a segment
+         * overlaps.
+         *
+         * @param a        The first segment point
+         * @param b        The second segment point
+         * @param function The function, called with the cell index
+         */
+        template <typename F>
+        void for_each_cell(const geometry::Point<T>& a, const geometry::Point<T>& b, F&& function) const
+        {
+            const std::size_t c0 = column(std::min(a.x(), b.x()));
+            const std::size_t c1 = column(std::max(a.x(), b.x()));
+            const std::size_t r0 = row(std::min(a.y(), b.y()));
+            const std::size_t r1 = row(std::max(a.y(), b.y()));
+            for (std::size_t r = r0; r <= r1; r++)
+            {
+                for (std::size_t c = c0; c <= c1; c++)
+                {
+                    function(r * m_columns + c);
+                }
+            }
+        }
+
+    public:
+
+        /* Methods */
+
+        /**
+         * Insert a segment into the grid.
+         *
+         * @param id The segment id
+         * @param a  The first segment point
+         * @param b  The second segment point
+         */
+        void insert(std::size_t id, const geometry::Point<T>& a, const geometry::Point<T>& b)
+        {
+            if (id >= m_stamps.size())
+            {
+                m_stamps.resize(id + 1, 0);
+            }
+            for_each_cell(a, b, [&](std::size_t cell) {
+                m_cells[cell].push_back(id);
+            });
+        }
+
+        /**
+         * Call a function for each segment in the cells that the bounding box
+         * of a query segment overlaps. Segments in multiple cells are
+         * reported once.
+         *
+         * @param a        The first query segment point
+         * @param b        The second query segment point
+         * @param function The function, called with the segment id
+         */
+        template <typename F>
+        void query(const geometry::Point<T>& a, const geometry::Point<T>& b, F&& function)
+        {
+            ++m_query;
+            for_each_cell(a, b, [&](std::size_t cell) {
+                for (const std::size_t id : m_cells[cell])
+                {
+                    if (m_stamps[id] != m_query)
+                    {
+                        m_stamps[id] = m_query;
+                        function(id);
+                    }
+                }
+            });
+        }
+
+    };
+
+}
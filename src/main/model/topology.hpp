@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <osmium/osm/location.hpp>
+
+#include "model/node_index.hpp"
+#include "model/types.hpp"
+
+namespace model
+{
+
+    /**
+     * A reference from a way to one of the arcs of a topology. A reversed
+     * reference traverses the nodes of the arc from back to front.
+     */
+    struct ArcRef
+    {
+        std::size_t arc;
+        bool reversed;
+    };
+
+    /**
+     * The shared-arc topology of a set of ways.
+     *
+     * The ways are split at junction nodes into arcs, and each arc is stored
+     * only once, even if it is part of the ways of multiple boundaries. A
+     * junction is a node where ways end or where the borders of different
+     * boundaries meet or part. The inner nodes of an arc are not shared with
+     * any other arc, so each arc can be processed independently and shared
+     * borders are processed exactly once.
+     *
+     * The nodes are referenced by their dense index in the node index.
+     */
+    struct Topology
+    {
+        /**
+         * The mapping from node ids to dense node indices.
+         */
+        NodeIndex nodes;
+
+        /**
+         * The node locations, indexed by the dense node index.
+         */
+        std::vector<osmium::Location> locations;
+
+        /**
+         * The junction flags, indexed by the dense node index.
+         */
+        std::vector<bool> junctions;
+
+        /**
+         * The arcs as sequences of dense node indices, which start and end
+         * at a junction.
+         */
+        std::vector<std::vector<std::size_t>> arcs;
+
+        /**
+         * The way ids in buffer order.
+         */
+        std::vector<object_id_type> ways;
+
+        /**
+         * The arcs of each way in the order of the ways.
+         */
+        std::vector<std::vector<ArcRef>> way_arcs;
+    };
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <osmium/index/map.hpp>
+#include <osmium/osm/location.hpp>
 #include <osmium/osm/types.hpp>
 
 namespace model
@@ -27,4 +29,14 @@ namespace model
      */
     using army_type = signed short;
 
+    /**
+     * The type for node location indices. This is the abstract base class of
+     * all osmium index maps, so the actual storage can be selected at
+     * runtime.
+     *
+     * For more information, refer to
+     * https://osmcode.org/osmium-concepts/#indexes
+     */
+    using location_index_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
+
 }
\ No newline at end of file
@@ -1,12 +1,15 @@
 #pragma once
 
+#include <optional>
 #include <regex>
 
 #include <osmium/memory/buffer.hpp>
 
 #include "routine.hpp"
 #include "io/reader/osm_reader.hpp"
+#include "io/reader/poly_reader.hpp"
 #include "io/writer/osm_writer.hpp"
+#include "model/clip_window.hpp"
 
 #include "util/log.hpp"
 #include "util/validate.hpp"
@@ -35,6 +38,41 @@ class Prepare : public Routine
     */
     std::string m_format;
 
+    /**
+     * The single pass flag. If set to true, the input file is decoded only
+     * once.
+     */
+    bool m_single_pass;
+
+    /**
+     * The number of worker threads. If set to 0, the number of threads is
+     * determined automatically.
+     */
+    int m_threads;
+
+    /**
+     * The metadata flag. If set to true, the object metadata (version,
+     * changeset, timestamp, uid and user) is kept in the prepared file.
+     */
+    bool m_metadata;
+
+    /**
+     * The clip window as bounding box string. If set, only boundaries that
+     * intersect the window are extracted.
+     */
+    std::string m_bbox;
+
+    /**
+     * The clip window as polygon file. If set, only boundaries that
+     * intersect the window are extracted.
+     */
+    fs::path m_poly;
+
+    /**
+     * The clip window created from the bounding box or the polygon file.
+     */
+    std::optional<model::ClipWindow> m_clip;
+
     /**
     * The logger.
     */
@@ -50,6 +88,11 @@ public:
             ("input", po::value<fs::path>()->required(), "Sets the input file path.\nAllowed file formats: .osm, .pbf")
             ("outdir,o", po::value<fs::path>()->default_value(""), "Sets the output directory of the prepared boundaries file. If not set, the file will be stored in the executable directory.")
             ("format,f", po::value<std::string>()->default_value("osm.pbf"), "Sets the output format.\n Allowed formats: osm, pbf")
+            ("single-pass", po::bool_switch()->default_value(false), "Reads the input file with a single decoding pass.\nThis is faster for large files, but keeps the locations of all nodes in memory.\nNodes only keep their location, ways without boundary tags only their node list.\nImplies --no-metadata.")
+            ("threads,j", po::value<int>()->default_value(0), "Sets the number of worker threads.\nIf set to 0, the number of threads is determined automatically.")
+            ("no-metadata", po::bool_switch()->default_value(false), "Skips the object metadata (version, changeset, timestamp, uid and user) in the prepared file, which reduces its size.")
+            ("bbox", po::value<std::string>()->default_value(""), "Sets the clip window as bounding box with the format min_lon,min_lat,max_lon,max_lat.\nOnly boundaries that intersect the window are extracted.")
+            ("poly", po::value<fs::path>()->default_value(""), "Sets the clip window as polygon file in the Osmosis polygon format.\nOnly boundaries that intersect the window are extracted.")
             ("help,h", "Shows this help message");
         m_positional.add("input", 1);
     }
@@ -67,17 +110,33 @@ public:
         this->set<fs::path>(&m_input, "input", util::validate_file);
         this->set<fs::path>(&m_outdir, "outdir", m_dir, util::validate_dir);
         this->set<std::string>(&m_format, "format", util::validate_format);
-        m_log.set_steps(2);
+        this->set<bool>(&m_single_pass, "single-pass");
+        this->set<int>(&m_threads, "threads", util::validate_threads);
+        this->set<bool>(&m_metadata, "no-metadata");
+        m_metadata = !m_metadata;
+        if (m_single_pass && m_metadata)
+        {
+            // The single pass mode does not keep the object metadata
+            m_log.warn() << "The parameter 'single-pass' implies 'no-metadata', the object metadata is not kept.\n";
+            m_metadata = false;
+        }
+        this->set<std::string>(&m_bbox, "bbox", util::validate_bbox);
+        this->set<fs::path>(&m_poly, "poly");
+        util::validate_clip(m_bbox, m_poly);
+        if (!m_bbox.empty())
+        {
+            m_clip = model::ClipWindow{ util::parse_bbox(m_bbox) };
+        }
+        else if (!m_poly.empty())
+        {
+            io::PolyReader poly_reader{ m_poly };
+            m_clip = model::ClipWindow{ poly_reader.read() };
+        }
+        m_log.set_steps(1);
     }
 
     void run() override
     {
-        // Read the boundaries from the specified input file
-        m_log.start() << "Preparing file " << m_input << ".\n";
-        io::BoundaryReader reader{m_input};
-        osmium::memory::Buffer buffer = reader.read();
-        m_log.finish();
-        
         // Prepare the outfile path
         std::string outfile_name = std::regex_replace(
             m_input.filename().string(),
@@ -87,10 +146,23 @@ public:
         outfile_name += "-prepared";
         fs::path outfile_path = m_outdir / fs::path(outfile_name).replace_extension(m_format);
 
-        // Write the boundaries to the output
-        m_log.start() << "Writing boundaries to file " << outfile_path << ".\n";
+        // Stream the boundaries from the specified input file to the output
+        // file, such that the extracted boundaries are never held in memory
+        // at once
+        m_log.start() << "Preparing file " << m_input << " and writing boundaries to file " << outfile_path << ".\n";
+        io::BoundaryReader reader{ m_input };
+        reader.mode(m_single_pass ? io::read_mode::single_pass : io::read_mode::multi_pass);
+        reader.threads(m_threads);
+        reader.metadata(m_metadata);
+        if (m_clip.has_value())
+        {
+            reader.clip(m_clip.value());
+        }
         io::BoundaryWriter writer{outfile_path};
-        writer.write(std::move(buffer));
+        reader.stream([&](osmium::memory::Buffer&& buffer) {
+            writer.write(std::move(buffer));
+        });
+        writer.close();
         m_log.finish();
 
         m_log.end();
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "model/geometry/rectangle.hpp"
+
+namespace util
+{
+
+    /**
+     * Parses a bounding box string with the format
+     * "min_lon,min_lat,max_lon,max_lat" in degrees.
+     *
+     * @param bbox The bounding box string
+     * @returns    The bounding box
+     * @throws     std::invalid_argument if the string is not a valid
+     *             bounding box
+     */
+    model::geometry::Rectangle<double> parse_bbox(const std::string& bbox)
+    {
+        std::istringstream stream{ bbox };
+        double values[4];
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            char separator = ',';
+            if ((i > 0 && !(stream >> separator)) || separator != ',' || !(stream >> values[i]))
+            {
+                throw std::invalid_argument("Bounding box '" + bbox + "' does not have the format min_lon,min_lat,max_lon,max_lat");
+            }
+        }
+        stream >> std::ws;
+        if (!stream.eof())
+        {
+            throw std::invalid_argument("Bounding box '" + bbox + "' does not have the format min_lon,min_lat,max_lon,max_lat");
+        }
+        model::geometry::Rectangle<double> rectangle{ values[0], values[1], values[2], values[3] };
+        if (!rectangle.valid()
+            || rectangle.min().x() < -180.0 || rectangle.max().x() > 180.0
+            || rectangle.min().y() < -90.0 || rectangle.max().y() > 90.0)
+        {
+            throw std::invalid_argument("Bounding box '" + bbox + "' is not a valid area in degrees");
+        }
+        return rectangle;
+    }
+
+}
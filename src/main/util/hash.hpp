@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace util
+{
+
+    /* Constants */
+
+    const std::uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+    const std::uint64_t FNV_PRIME = 1099511628211ULL;
+
+    /**
+     * An incremental 64-bit FNV-1a hash. The hash is not cryptographic, but
+     * fast and stable across platforms and program runs, which makes it
+     * suitable for cache keys.
+     *
+     * For more information, refer to
+     * http://www.isthe.com/chongo/tech/comp/fnv/index.html
+     */
+    class Hasher
+    {
+    protected:
+
+        /* Members */
+
+        /**
+         * The current hash value.
+         */
+        std::uint64_t m_hash = FNV_OFFSET_BASIS;
+
+    public:
+
+        /* Methods */
+
+        /**
+         * Add a sequence of bytes to the hash.
+         *
+         * @param data The pointer to the first byte
+         * @param size The number of bytes
+         *
+         * Time complexity: Linear
+         */
+        void add(const void* data, std::size_t size)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                m_hash ^= bytes[i];
+                m_hash *= FNV_PRIME;
+            }
+        }
+
+        /**
+         * Add a string to the hash. The string is terminated with a null
+         * byte, such that the concatenations of different strings do not
+         * collide.
+         *
+         * @param value The string
+         */
+        void add(const std::string& value)
+        {
+            add(value.c_str(), value.size() + 1);
+        }
+
+        /**
+         * Add an integral value to the hash.
+         *
+         * @param value The value
+         */
+        template <typename T>
+        std::enable_if_t<std::is_integral_v<T>> add(T value)
+        {
+            add(&value, sizeof(T));
+        }
+
+        /* Accessors */
+
+        std::uint64_t value() const noexcept
+        {
+            return m_hash;
+        }
+
+        /**
+         * Retrieve the hash value as zero-padded hexadecimal string.
+         *
+         * @returns The hexadecimal hash string
+         */
+        std::string hex() const
+        {
+            std::stringstream stream;
+            stream << std::hex << std::setw(16) << std::setfill('0') << m_hash;
+            return stream.str();
+        }
+
+    };
+
+}
@@ -1,10 +1,50 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
+
 #include "model/header.hpp"
 
 namespace util
 {
 
+    /**
+     * Prints an optional count to a specified output stream, or a dash if
+     * the count is empty.
+     *
+     * @param stream The output stream
+     * @param count  The optional count
+     */
+    template <typename StreamType>
+    void print(StreamType& stream, const std::optional<std::size_t>& count)
+    {
+        if (count.has_value())
+        {
+            stream << count.value();
+        }
+        else
+        {
+            stream << "-";
+        }
+    }
+
+    /**
+     * Prints the confidence margin of an estimated count to a specified
+     * output stream. Nothing is printed if the header was not estimated.
+     *
+     * @param stream The output stream
+     * @param header The header container
+     * @param margin The accessor for the margin of the estimate
+     */
+    template <typename StreamType, typename Accessor>
+    void print_margin(StreamType& stream, const model::Header& header, Accessor margin)
+    {
+        if (header.estimate.has_value())
+        {
+            stream << " (+/- " << margin(header.estimate.value()) << ")";
+        }
+    }
+
     /**
      * Prints the contents of a header container to a specified output stream.
      * 
@@ -20,18 +60,43 @@ namespace util
             << "  " << "Compression: " << header.compression << '\n'
             << "  " << "Size: " << header.size << '\n'
             << "Objects:" << '\n'
-            << "  " << "Nodes: " << header.nodes << '\n'
-            << "  " << "Ways: " << header.ways << '\n'
-            << "  " << "Relations: " << header.relations << '\n'
-            << "Bounding Box:" << '\n'
-            << "  " << "Min: (" << header.bounds.bottom_left().lon() << ", " << header.bounds.bottom_left().lat() << ")" << '\n' 
-            << "  " << "Max: (" << header.bounds.top_right().lon() << ", " << header.bounds.top_right().lat() << ")" << '\n'
-            << "Boundaries: " << '\n'
-            << "  " << "Total: " << header.boundaries << '\n'
+            << "  " << "Nodes: ";
+        print(stream, header.nodes);
+        print_margin(stream, header, [](const model::Estimate& e) { return e.nodes; });
+        stream << '\n'
+            << "  " << "Ways: ";
+        print(stream, header.ways);
+        print_margin(stream, header, [](const model::Estimate& e) { return e.ways; });
+        stream << '\n'
+            << "  " << "Relations: " << header.relations;
+        print_margin(stream, header, [](const model::Estimate& e) { return e.relations; });
+        stream << '\n'
+            << "Bounding Box:" << '\n';
+        if (header.bounds.valid())
+        {
+            stream << "  " << "Min: (" << header.bounds.bottom_left().lon() << ", " << header.bounds.bottom_left().lat() << ")" << '\n' 
+                << "  " << "Max: (" << header.bounds.top_right().lon() << ", " << header.bounds.top_right().lat() << ")" << '\n';
+        }
+        else
+        {
+            stream << "  -" << '\n';
+        }
+        stream << "Boundaries: " << '\n'
+            << "  " << "Total: " << header.boundaries;
+        print_margin(stream, header, [](const model::Estimate& e) { return e.boundaries; });
+        stream << '\n'
             << "  " << "Level Distribution: " << '\n';
         for (const auto& [level, count] : header.levels)
         {
-            stream << "   L" << level << ": " << count << '\n';
+            stream << "   L" << level << ": " << count;
+            print_margin(stream, header, [level = level](const model::Estimate& e) { return e.levels.at(level); });
+            stream << '\n';
+        }
+        if (header.estimate.has_value())
+        {
+            stream << "Estimate:" << '\n'
+                << "  " << "Decoded Blocks: " << header.estimate->samples << " of " << header.estimate->blocks << '\n'
+                << "  " << "Confidence Level: 95%" << '\n';
         }
         stream << std::endl;
     };
@@ -9,6 +9,7 @@
 #include <boost/filesystem/operations.hpp>
 
 #include "model/types.hpp"
+#include "util/bbox.hpp"
 #include "util/join.hpp"
 
 namespace fs = boost::filesystem;
@@ -20,6 +21,15 @@ namespace util
 
     const std::vector<std::string> ALLOWED_OSM_FORMATS{ "osm", "pbf", "osm.pbf" };
 
+    // The sparse memory mapped index is only available on Linux
+#ifdef __linux__
+    const std::vector<std::string> ALLOWED_INDEX_TYPES{ "flex", "sparse_mmap", "dense_file" };
+#else
+    const std::vector<std::string> ALLOWED_INDEX_TYPES{ "flex", "dense_file" };
+#endif
+
+    const std::vector<std::string> ALLOWED_SIMPLIFY_MODES{ "dp", "vw" };
+
 
     /* Simple Validation Functions */
 
@@ -89,6 +99,22 @@ namespace util
         }
     }
 
+    void validate_index(std::string& type, std::string name)
+    {
+        if (std::find(ALLOWED_INDEX_TYPES.begin(), ALLOWED_INDEX_TYPES.end(), type) == ALLOWED_INDEX_TYPES.end())
+        {
+            throw std::invalid_argument("The specified index type " + type + " for parameter '" + name + "' is not supported.\nSupported types are " + util::join(ALLOWED_INDEX_TYPES));
+        }
+    }
+
+    void validate_simplify(std::string& mode, std::string name)
+    {
+        if (std::find(ALLOWED_SIMPLIFY_MODES.begin(), ALLOWED_SIMPLIFY_MODES.end(), mode) == ALLOWED_SIMPLIFY_MODES.end())
+        {
+            throw std::invalid_argument("The specified simplification mode " + mode + " for parameter '" + name + "' is not supported.\nSupported modes are " + util::join(ALLOWED_SIMPLIFY_MODES));
+        }
+    }
+
     void validate_epsilon(double& epsilon, std::string name)
     {
         if (epsilon < 0)
@@ -100,6 +126,64 @@ namespace util
         }
     }
 
+    void validate_samples(int& samples, std::string name)
+    {
+        if (samples < 2)
+        {
+            throw std::invalid_argument(
+                "Invalid sample size " + std::to_string(samples) + " for parameter '" + name + "'."
+                + " At least 2 blocks have to be sampled"
+            );
+        }
+    }
+
+    void validate_bbox(std::string& bbox, std::string name)
+    {
+        if (bbox.empty())
+        {
+            return;
+        }
+        try
+        {
+            parse_bbox(bbox);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            throw std::invalid_argument(std::string(e.what()) + " for parameter '" + name + "'");
+        }
+    }
+
+    void validate_tolerances(double compression_tolerance, double pixel_tolerance)
+    {
+        if (compression_tolerance > 0 && pixel_tolerance > 0)
+        {
+            throw std::invalid_argument("The parameters 'compression-tolerance' and 'pixel-tolerance' cannot be combined.");
+        }
+    }
+
+    void validate_clip(std::string& bbox, fs::path& poly)
+    {
+        if (!bbox.empty() && !poly.empty())
+        {
+            throw std::invalid_argument("Only one of the parameters 'bbox' and 'poly' can be specified");
+        }
+        if (!poly.empty())
+        {
+            validate_file(poly, "poly");
+        }
+    }
+
+    void validate_threads(int& threads, std::string name)
+    {
+        if (threads < 0)
+        {
+            throw std::invalid_argument(
+                "Invalid thread count " + std::to_string(threads) + " for parameter '" + name + "'."
+                + " Thread counts have to be positive or equal to 0 (auto)"
+            );
+        }
+    }
+
 
     /* Dependent Validation Functions */
 